@@ -1,8 +1,27 @@
-F:\1.2.176.1\Bin32\glslc.exe testVert.vert -o testVert.spv
-F:\1.2.176.1\Bin32\glslc.exe testFrag.frag -o testFrag.spv
-F:\1.2.176.1\Bin32\glslc.exe spectrum.comp -o spectrum.spv
-F:\1.2.176.1\Bin32\glslc.exe FFT.comp -o FFT.spv
-F:\1.2.176.1\Bin32\glslc.exe oceanNormal.comp -o oceanNormal.spv
-F:\1.2.176.1\Bin32\glslc.exe ui.vert -o ui.vert.spv
-F:\1.2.176.1\Bin32\glslc.exe ui.frag -o ui.frag.spv
-pause
\ No newline at end of file
+@echo off
+rem Compiles every shader of this folder with glslc and validates the result with spirv-val.
+rem Run by the pre-build step of Sandbox with "nopause", the SDK is found through VULKAN_SDK.
+if not defined VULKAN_SDK set VULKAN_SDK=F:\1.2.176.1
+set GLSLC="%VULKAN_SDK%\Bin\glslc.exe"
+set SPIRV_VAL="%VULKAN_SDK%\Bin\spirv-val.exe"
+
+call :compile testVert.vert testVert.spv || goto failed
+call :compile testFrag.frag testFrag.spv || goto failed
+call :compile FFT.comp FFT.spv || goto failed
+call :compile FFTStockham.comp FFTStockham.spv || goto failed
+call :compile oceanNormal.comp oceanNormal.spv || goto failed
+call :compile ui.vert ui.vert.spv || goto failed
+call :compile ui.frag ui.frag.spv || goto failed
+
+if not "%1"=="nopause" pause
+exit /b 0
+
+:compile
+%GLSLC% %1 -o %2 || exit /b 1
+%SPIRV_VAL% --target-env vulkan1.0 %2 || exit /b 1
+exit /b 0
+
+:failed
+echo compile.bat: failed to build the shaders
+if not "%1"=="nopause" pause
+exit /b 1
@@ -0,0 +1,126 @@
+// h(k, t) and the derived channels of one bin, evaluated by the first FFT pass for its own row.
+// Included by FFT.comp and FFTStockham.comp, which bind m_DescriptorSets[0] as set 0 for it.
+
+layout(std430, set = 0, binding = 0) buffer H0Buffer
+{
+	vec2 H0Buffers[ ];
+};
+
+layout (std140, set = 0, binding = 3) uniform UBO
+{
+	float deltaT;
+	float lambda;
+	uint meshSize;
+	uint OceanSizeLx;
+	uint OceanSizeLz;
+	uint timeStepMode;
+	uint renormalize;
+} ubo;
+
+// (e^(iwt) of the last step, e^(iw dt)) per bin, see OceanPhase.h
+layout(std430, set = 0, binding = 6) buffer PhaseBuffer
+{
+	vec4 Phases[ ];
+};
+
+// (kx, kz, w, 1 / |k|) per bin, see OceanDispersion.h
+layout(std430, set = 0, binding = 7) readonly buffer WaveBuffer
+{
+	vec4 Waves[ ];
+};
+
+const uint TIME_STEP_ABSOLUTE = 0;
+const uint TIME_STEP_INCREMENTAL = 1;
+
+vec2 conjugate(vec2 arg)
+{
+    vec2 f2;
+    f2.x = arg.x;
+    f2.y = -arg.y;
+    return f2;
+}
+
+vec2 MultiplyComplex(vec2 a, vec2 b)
+{
+	return vec2(a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x);
+}
+
+vec2 AddComplex(vec2 a, vec2 b)
+{
+	return vec2(a.x + b.x , a.y + b.y);
+}
+
+vec2 ComplexExp(float a)
+{
+    return vec2(cos(a), sin(a));
+}
+
+// The packed planes of HtBuffers at (row, col): 0 = (ht_y, 0), 1 = (dx, dz), 2 = (ht_dx, ht_dz).
+// Every bin has to be evaluated exactly once per step, in TIME_STEP_INCREMENTAL the phase is advanced
+// here unless storePhase is false.
+void EvaluateSpectrum(uint row, uint col, bool storePhase, out vec2 planes[3])
+{
+	uint in_index = row * ubo.meshSize + col;
+    uint in_mindex = (ubo.meshSize - row) % ubo.meshSize * ubo.meshSize + (ubo.meshSize - col) % ubo.meshSize; // mirrored
+
+	vec4 wave = Waves[in_index];
+	vec2 k = wave.xy;
+
+	// e^(iwt), e^(-iwt) is its conjugate
+	vec2 phasor;
+	if (ubo.timeStepMode == TIME_STEP_INCREMENTAL)
+	{
+		// one fixed step per dispatch, no trig
+		vec4 phase = Phases[in_index];
+		phasor = MultiplyComplex(phase.xy, phase.zw);
+		if (ubo.renormalize != 0)
+		{
+			phasor *= 1.5 - 0.5 * dot(phasor, phasor);
+		}
+		if (storePhase)
+		{
+			Phases[in_index].xy = phasor;
+		}
+	}
+	else
+	{
+		phasor = ComplexExp(wave.z * ubo.deltaT);
+	}
+
+	vec2 h0_k  = H0Buffers[in_index];
+	vec2 h0_mk = H0Buffers[in_mindex];
+
+	vec2 htval = AddComplex(
+			MultiplyComplex(h0_k, phasor),
+			MultiplyComplex(conjugate(h0_mk), conjugate(phasor)));
+
+	// ht_dx, ht_dz
+	vec2 htival; // i*htval
+	htival.x = -htval.y;
+	htival.y = htval.x;
+	vec2 ht_dx = htival * k.x;
+	vec2 ht_dz = htival * k.y;
+
+	k *= wave.w;
+
+	vec2 dx = -htival * k.x;
+	vec2 dz = -htival * k.y;
+
+	// The Nyquist column (row) of the x (z) channels is its own mirror but anti-Hermitian,
+	// so it only adds an imaginary part to the transform. Drop it to keep the packing exact.
+	if (col == 0)
+	{
+		ht_dx = vec2(0.0);
+		dx = vec2(0.0);
+	}
+	if (row == 0)
+	{
+		ht_dz = vec2(0.0);
+		dz = vec2(0.0);
+	}
+
+	// Each channel is Hermitian, so two of them are packed into one transform as a + ib.
+	planes[0] = htval;
+	planes[1] = AddComplex(dx, vec2(-dz.y, dz.x));
+	planes[2] = AddComplex(ht_dx, vec2(-ht_dz.y, ht_dz.x));
+}
@@ -16,9 +16,11 @@ layout(push_constant) uniform Push
 	mat4 NormalMatrix;
 } push;
 
-layout(std430, set = 0, binding = 0) buffer HtBuffer
+// HeightMap::m_HistorySlotCount published steps, each slot holds
+// H_y (plane 0), (Dx, Dz) (plane 1) and the normal map as pairs of vec2
+layout(std430, set = 0, binding = 0) readonly buffer HistoryBuffer
 {
-	vec2 HtBuffers[];
+	vec2 History[];
 };
 
 layout(std140, set = 0, binding = 1) uniform UBO
@@ -41,27 +43,48 @@ layout(std140, set = 0, binding = 2) uniform GlobalUBO
 	vec3 CameraPos;
 } globalUbo;
 
-layout(binding = 3, rgba32f) uniform readonly image2D OceanNormalImage;
+layout(std140, set = 0, binding = 5) uniform InterpolationUBO
+{
+	float alpha;
+	uint previousSlot;
+	uint currentSlot;
+	uint slotStride;
+} interpolation;
 
 const float heightScale = 1.0f;
 
 void main()
 {
 	uint offset = ubo.meshSize * ubo.meshSize;
+	uint previousBase = interpolation.previousSlot * interpolation.slotStride;
+	uint currentBase = interpolation.currentSlot * interpolation.slotStride;
+	float alpha = interpolation.alpha;
+
+	// blend the two latest steps for the render time
+	uint index = uint(gl_VertexIndex);
+	float height = mix(History[previousBase + index].x, History[currentBase + index].x, alpha);
+	// plane 1 holds (dx, dz)
+	index += offset;
+	vec2 displacement = mix(History[previousBase + index], History[currentBase + index], alpha);
+	// the normal map follows the two planes, one vec4 (two vec2) per vertex
+	index = offset * 2 + uint(gl_VertexIndex) * 2;
+	vec3 normal = mix(
+		vec3(History[previousBase + index], History[previousBase + index + 1].x),
+		vec3(History[currentBase + index], History[currentBase + index + 1].x),
+		alpha);
 
 	vec4 positionWorld = push.ModelMatrix * vec4(
-		pos.x + (HtBuffers[gl_VertexIndex + offset * 3].x * ubo.lambda),	// dx
-		pos.y + (HtBuffers[gl_VertexIndex + offset * 0].x),	// ht_y
-		pos.z + (HtBuffers[gl_VertexIndex + offset * 4].x * ubo.lambda),	// dz
+		pos.x + (displacement.x * ubo.lambda),	// dx
+		pos.y + height,	// ht_y
+		pos.z + (displacement.y * ubo.lambda),	// dz
 		1.0);
 
-	ivec2 texCoords = ivec2(vertTexCoords.x * 255, vertTexCoords.y * 255);
-
-	vec4 normalImage = imageLoad(OceanNormalImage, texCoords);
+	float lastCell = float(ubo.meshSize - 1);
+	ivec2 texCoords = ivec2(vertTexCoords.x * lastCell, vertTexCoords.y * lastCell);
 
 	gl_Position = globalUbo.ProjectionView * positionWorld;
 	fragWorldPos = positionWorld;
-	fragWorldNormal = normalize(mat3(push.NormalMatrix) * normalImage.xyz);
+	fragWorldNormal = normalize(mat3(push.NormalMatrix) * normal);
 	fragColor = color;
 	fragTexCoords = texCoords;
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "VoeImgui.h"
 #include "VulkanCore/Device.h"
 #include "Renderer/FrameInfo.h"
+#include "Renderer/HeightMap/OceanSimulationThread.h"
 #include "Renderer/Swapchain.h"
 
 #include "VOceanEngine/Input.h"
@@ -217,6 +218,14 @@ namespace voe {
 		ImGui::Text("Camera");
 		ImGui::InputFloat3("position", &cameraPos.x, 2);
 		ImGui::InputFloat3("rotation", &cameraRot.x, 2);
+
+		if (frameInfo.OceanState != nullptr)
+		{
+			ImGui::Text("CPU ocean: step %llu, t = %.2f, %.2f ms",
+				static_cast<unsigned long long>(frameInfo.OceanState->StepIndex),
+				frameInfo.OceanState->Time,
+				frameInfo.OceanState->StepMilliseconds);
+		}
 		ImGui::End();
 
 		ImGui::SetNextWindowSize(ImVec2(400, 100), ImGuiCond_Once);
@@ -38,7 +38,8 @@ namespace voe {
         uint32_t instanceCount,
         VkBufferUsageFlags usageFlags,
         VkMemoryPropertyFlags memoryPropertyFlags,
-        VkDeviceSize minOffsetAlignment)
+        VkDeviceSize minOffsetAlignment,
+        VkSharingMode sharingMode)
         : m_Device{ device },
         m_InstanceSize{ instanceSize },
         m_InstanceCount{ instanceCount },
@@ -47,7 +48,7 @@ namespace voe {
     {
         m_AlignmentSize = GetAlignment(instanceSize, minOffsetAlignment);
         m_BufferSize = m_AlignmentSize * m_InstanceCount;
-        device.CreateBuffer(m_BufferSize, usageFlags, memoryPropertyFlags, m_Buffer, m_Memory);
+        device.CreateBuffer(m_BufferSize, usageFlags, memoryPropertyFlags, m_Buffer, m_Memory, sharingMode);
     }
 
     Buffer::~Buffer() {
@@ -12,7 +12,8 @@ namespace voe {
             uint32_t instanceCount,
             VkBufferUsageFlags usageFlags,
             VkMemoryPropertyFlags memoryPropertyFlags,
-            VkDeviceSize minOffsetAlignment = 1);
+            VkDeviceSize minOffsetAlignment = 1,
+            VkSharingMode sharingMode = VK_SHARING_MODE_EXCLUSIVE);
         ~Buffer();
 
         Buffer(const Buffer&) = delete;
@@ -9,9 +9,10 @@ namespace voe {
 		Device& device,
 		const std::string& compFilepath,
         VkPipelineLayout layout,
-        VkPipelineCache cache) : m_Device{ device }
+        VkPipelineCache cache,
+        const VkSpecializationInfo* specializationInfo) : m_Device{ device }
 	{
-		CreateComputePipeline(compFilepath, layout, cache);
+		CreateComputePipeline(compFilepath, layout, cache, specializationInfo);
 	}
 
 	ComputePipeline::~ComputePipeline()
@@ -39,7 +40,11 @@ namespace voe {
         return buffer;
     }
 
-    void ComputePipeline::CreateComputePipeline(const std::string& compFilepath, VkPipelineLayout layout, VkPipelineCache cache)
+    void ComputePipeline::CreateComputePipeline(
+        const std::string& compFilepath,
+        VkPipelineLayout layout,
+        VkPipelineCache cache,
+        const VkSpecializationInfo* specializationInfo)
     {
         auto compCode = ReadFile(compFilepath);
 
@@ -52,7 +57,7 @@ namespace voe {
         shaderStage.pName = "main";
         shaderStage.flags = 0;
         shaderStage.pNext = nullptr;
-        shaderStage.pSpecializationInfo = nullptr;
+        shaderStage.pSpecializationInfo = specializationInfo;
 
         VkComputePipelineCreateInfo pipelineCreateInfo = {};
         pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
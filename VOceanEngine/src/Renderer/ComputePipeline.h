@@ -11,7 +11,8 @@ namespace voe {
 			Device& device,
 			const std::string& compFilepath,
 			VkPipelineLayout layout = nullptr,
-			VkPipelineCache cache = nullptr);
+			VkPipelineCache cache = nullptr,
+			const VkSpecializationInfo* specializationInfo = nullptr);
 
 		~ComputePipeline();
 
@@ -22,7 +23,11 @@ namespace voe {
 		static std::vector<char> ReadFile(const std::string& filepath);
 
 	private:
-		void CreateComputePipeline(const std::string& compFilepath, VkPipelineLayout layout, VkPipelineCache cache);
+		void CreateComputePipeline(
+			const std::string& compFilepath,
+			VkPipelineLayout layout,
+			VkPipelineCache cache,
+			const VkSpecializationInfo* specializationInfo);
 		void CreateShaderModule(const std::vector<char>& code, VkShaderModule* shaderModule);
 
 		Device& m_Device;
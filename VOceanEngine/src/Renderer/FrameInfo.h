@@ -7,11 +7,15 @@
 
 
 namespace voe {
+	struct OceanSnapshot;
+
 	struct FrameInfo  {
 		int FrameIndex;
 		float FrameTime;
 		VkCommandBuffer CommandBuffer;
 		Camera& CameraObj;
+		// latest step of the CPU ocean simulation, nullptr if there is none yet
+		const OceanSnapshot* OceanState = nullptr;
 	};
 
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include "Renderer/Swapchain.h"
 #include "Renderer/HeightMap/HeightMap.h"
 #include "Renderer/HeightMap/TessendorfOceane.h"
+#include "Renderer/HeightMap/SpectrumCache.h"
+#include "Renderer/HeightMap/OceanLoop.h"
 
 namespace voe {
 
@@ -12,13 +14,13 @@ namespace voe {
 		m_H0BufferDscInfo  = new VkDescriptorBufferInfo();
 		m_HtBufferDscInfo = new VkDescriptorBufferInfo();
 		m_Ht_dmyBufferDscInfo = new VkDescriptorBufferInfo();
+		m_PhaseBufferDscInfo = new VkDescriptorBufferInfo();
+		m_WaveBufferDscInfo = new VkDescriptorBufferInfo();
+		m_TwiddleBufferDscInfo = new VkDescriptorBufferInfo();
+		m_BitReverseBufferDscInfo = new VkDescriptorBufferInfo();
+		m_HistoryBufferDscInfo = new VkDescriptorBufferInfo();
 		m_UniformBufferDscInfo = new VkDescriptorBufferInfo();
-
-		for (uint32_t i = 0; i < m_OceanElementCount; i++)
-		{
-			m_HtBufferDscInfos[i] = new VkDescriptorBufferInfo();
-			m_Ht_dmyBufferDscInfos[i] = new VkDescriptorBufferInfo();
-		}
+		m_InterpolationBufferDscInfo = new VkDescriptorBufferInfo();
 	}
 
 	HeightMap::~HeightMap()
@@ -26,13 +28,13 @@ namespace voe {
 		delete m_H0BufferDscInfo;
 		delete m_HtBufferDscInfo;
 		delete m_Ht_dmyBufferDscInfo;
+		delete m_PhaseBufferDscInfo;
+		delete m_WaveBufferDscInfo;
+		delete m_TwiddleBufferDscInfo;
+		delete m_BitReverseBufferDscInfo;
+		delete m_HistoryBufferDscInfo;
 		delete m_UniformBufferDscInfo;
-
-		for (uint32_t i = 0; i < m_OceanElementCount; i++)
-		{
-			delete m_HtBufferDscInfos[i];
-			delete m_Ht_dmyBufferDscInfos[i];
-		}
+		delete m_InterpolationBufferDscInfo;
 	}
 
 	void HeightMap::AddGraphicsToComputeBarriers(VkCommandBuffer commandBuffer)
@@ -50,144 +52,411 @@ namespace voe {
 
 	void HeightMap::CreateComputeUniformBuffers()
 	{
-		m_UniformBuffers.resize(Swapchain::MAX_FRAMES_IN_FLIGHT); // MAX_FRAMES_IN_FLIGHT
+		// one instance per frame in flight, selected with a dynamic offset
+		m_UniformBuffer = std::make_shared<Buffer>(
+			m_Device,
+			sizeof(ComputeUBO),
+			Swapchain::MAX_FRAMES_IN_FLIGHT,
+			VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+			m_Device.GetMinUniformBufferOffsetAlignment());
+
+		m_UniformBuffer->Map();
+		SetDescriptorBufferInfo(m_UniformBufferDscInfo, m_UniformBuffer->GetBuffer(), sizeof(ComputeUBO));
+
+		m_InterpolationBuffer = std::make_shared<Buffer>(
+			m_Device,
+			sizeof(InterpolationUBO),
+			Swapchain::MAX_FRAMES_IN_FLIGHT,
+			VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+			m_Device.GetMinUniformBufferOffsetAlignment());
+
+		m_InterpolationBuffer->Map();
+		SetDescriptorBufferInfo(m_InterpolationBufferDscInfo, m_InterpolationBuffer->GetBuffer(), sizeof(InterpolationUBO));
+	}
+
+	uint32_t HeightMap::GetUniformBufferOffset(uint32_t frameIndex)
+	{
+		return static_cast<uint32_t>(m_UniformBuffer->DescriptorInfoForIndex(frameIndex).offset);
+	}
+
+	uint32_t HeightMap::GetInterpolationBufferOffset(uint32_t frameIndex)
+	{
+		return static_cast<uint32_t>(m_InterpolationBuffer->DescriptorInfoForIndex(frameIndex).offset);
+	}
+
+	VkDeviceSize HeightMap::GetHistorySlotSize() const
+	{
+		VkDeviceSize elementCount = m_ComputeUBO.meshSize * m_ComputeUBO.meshSize;
+		return elementCount * (2 * sizeof(glm::vec2) + sizeof(glm::vec4));
+	}
+
+	VkDeviceSize HeightMap::GetHistoryNormalOffset() const
+	{
+		VkDeviceSize elementCount = m_ComputeUBO.meshSize * m_ComputeUBO.meshSize;
+		return elementCount * 2 * sizeof(glm::vec2);
+	}
+
+	VkDeviceSize HeightMap::GetPlaybackSlotSize() const
+	{
+		VkDeviceSize elementCount = m_ComputeUBO.meshSize * m_ComputeUBO.meshSize;
+		return GetHistorySlotSize() + elementCount * sizeof(float);
+	}
+
+	void HeightMap::UpdateComputeUniformBuffers(float dt, int frameIndex)
+	{
+		float stepSeconds = dt;
+		float alpha = 1.0f;
+		float stepRate = m_Playback ? m_PlaybackStepRate : m_FixedStepRate;
+
+		if (stepRate > 0.0f)
+		{
+			float interval = 1.0f / stepRate;
+			m_StepAccumulator += dt;
+			// the first frame always steps, the history is empty before that
+			m_StepPending = m_StepAccumulator >= interval || m_PublishedSteps == 0;
+			if (m_StepPending)
+			{
+				// at most one step per frame, time a long frame can't catch up on is dropped
+				m_StepAccumulator = std::clamp(m_StepAccumulator - interval, 0.0f, interval);
+			}
+
+			stepSeconds = interval;
+			alpha = std::min(m_StepAccumulator / interval, 1.0f);
+		}
+		else
+		{
+			m_StepPending = true;
+			if (m_TimeStepMode == TimeStepMode::Incremental)
+			{
+				stepSeconds = m_StepSeconds;
+			}
+		}
+
+		if (m_StepPending && !m_Playback)
+		{
+			m_ComputeUBO.deltaT += (m_OceanAnimRate * stepSeconds);
+
+			if (m_TimeStepMode == TimeStepMode::Incremental)
+			{
+				// spectrum.glsl advances the phasors by one fixed step per dispatch
+				m_StepCount++;
+				m_ComputeUBO.renormalize = m_StepCount % PhaseRenormalizeInterval == 0 ? 1 : 0;
+			}
+		}
+
+		if (m_StepPending)
+		{
+			// the step of this frame goes into the next slot, the latest one becomes the previous
+			uint32_t previousSlot = m_HistorySlot;
+			m_HistorySlot = m_PublishedSteps > 0 ? (m_HistorySlot + 1) % m_HistorySlotCount : 0;
+			m_InterpolationUBO.previousSlot = m_PublishedSteps > 0 ? previousSlot : m_HistorySlot;
+			m_InterpolationUBO.currentSlot = m_HistorySlot;
+			m_PublishedSteps++;
+
+			if (m_Playback)
+			{
+				// The copy that last read this staging slot was m_HistorySlotCount steps ago, at least as many
+				// frames as there are in flight, so it has finished.
+				uint8_t* staging = static_cast<uint8_t*>(m_PlaybackStagingBuffer->GetMappedMemory());
+				uint8_t* slot = staging + m_HistorySlot * GetPlaybackSlotSize();
+				m_Playback->ExpandFrame(m_PlaybackFrame, slot);
+				m_Playback->ExpandBubble(m_PlaybackFrame, reinterpret_cast<float*>(slot + GetHistorySlotSize()));
+				m_PlaybackFrame = (m_PlaybackFrame + 1) % m_Playback->GetFrameCount();
+			}
+		}
+
+		m_InterpolationUBO.alpha = alpha;
+		m_InterpolationUBO.slotStride = static_cast<uint32_t>(GetHistorySlotSize() / sizeof(glm::vec2));
+
+		m_UniformBuffer->WriteToIndex(&m_ComputeUBO, frameIndex);
+		m_UniformBuffer->FlushIndex(frameIndex);
+		m_InterpolationBuffer->WriteToIndex(&m_InterpolationUBO, frameIndex);
+		m_InterpolationBuffer->FlushIndex(frameIndex);
+	}
+
+	void HeightMap::SetTimeStepMode(TimeStepMode mode, float stepSeconds)
+	{
+		m_TimeStepMode = mode;
+		m_StepSeconds = m_FixedStepRate > 0.0f ? 1.0f / m_FixedStepRate : stepSeconds;
+		m_StepCount = 0;
+		m_ComputeUBO.timeStepMode = static_cast<uint32_t>(mode);
+		m_ComputeUBO.renormalize = 0;
+
+		if (mode == TimeStepMode::Incremental)
+		{
+			// restart the phasors from the current time, the next dispatch adds the first step
+			UploadPhases(m_ComputeUBO.deltaT, m_OceanAnimRate * m_StepSeconds);
+		}
+	}
+
+	void HeightMap::SetFixedStepRate(float stepsPerSecond)
+	{
+		m_FixedStepRate = std::max(stepsPerSecond, 0.0f);
+		m_StepAccumulator = 0.0f;
+
+		if (m_FixedStepRate > 0.0f && m_TimeStepMode == TimeStepMode::Incremental)
+		{
+			// the phases have to step by the new interval
+			SetTimeStepMode(m_TimeStepMode, 1.0f / m_FixedStepRate);
+		}
+	}
+
+	void HeightMap::SetPlayback(std::shared_ptr<const OceanLoop> loop)
+	{
+		if (loop && loop->GetMeshSize() != m_ComputeUBO.meshSize)
+		{
+			throw std::runtime_error("HeightMap: the ocean loop was baked for a different mesh size");
+		}
+
+		m_Playback = std::move(loop);
+		m_PlaybackFrame = 0;
+		m_StepAccumulator = 0.0f;
 
-		for (int i = 0; i < m_UniformBuffers.size(); i++)
+		if (!m_Playback)
 		{
-			m_UniformBuffers[i] = std::make_unique<Buffer>(
+			m_PlaybackStagingBuffer.reset();
+			m_PlaybackStepRate = 0.0f;
+			return;
+		}
+
+		m_PlaybackStepRate = m_OceanAnimRate * m_Playback->GetFrameCount() / m_Playback->GetPeriod();
+		// upload the first frame with the next update
+		m_StepAccumulator = 1.0f / m_PlaybackStepRate;
+
+		if (!m_PlaybackStagingBuffer)
+		{
+			m_PlaybackStagingBuffer = std::make_shared<Buffer>(
 				m_Device,
-				sizeof(ComputeUBO),
-				1, 
-				VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
-				m_Device.GetMinUniformBufferOffsetAlignment());
-
-			m_UniformBuffers[i]->Map();
-			SetDescriptorBufferInfo(m_UniformBufferDscInfo, m_UniformBuffers[i]->GetBuffer());
+				GetPlaybackSlotSize(),
+				m_HistorySlotCount,
+				VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+			m_PlaybackStagingBuffer->Map();
 		}
 	}
 
-	void HeightMap::UpdateComputeUniformBuffers(float dt, int frameIndex)
+	void HeightMap::UploadPhases(float time, float dt)
 	{
-		m_ComputeUBO.deltaT += (m_OceanAnimRate * dt);
-		m_UniformBuffers[frameIndex]->WriteToBuffer(&m_ComputeUBO);
-		m_UniformBuffers[frameIndex]->Flush();
+		std::vector<PhaseState> phases;
+		InitializePhases(m_Waves, time, dt, phases);
+
+		// a dispatch in flight may still step the old phases
+		vkQueueWaitIdle(m_CopyComputeQueue);
+
+		UploadToBuffer(*m_PhaseBuffer, phases.data(), phases.size() * sizeof(PhaseState));
 	}
 
-	void HeightMap::CreateHeightMap(uint32_t size)
+	void HeightMap::UploadToBuffer(Buffer& buffer, const void* data, VkDeviceSize size)
 	{
-		std::vector<glm::vec2> h0Buffer(size * size);
-		std::vector<glm::vec2> htBuffer(size * size * m_OceanElementCount);
+		Buffer stagingBuffer
+		{
+			m_Device,
+			size,
+			1,
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		};
+
+		stagingBuffer.Map();
+		stagingBuffer.WriteToBuffer(const_cast<void*>(data));
+
+		VkCommandBuffer copyCmd = m_Device.CreateCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY, true);
+		VkBufferCopy copyRegion = {};
+		copyRegion.size = size;
+
+		vkCmdCopyBuffer(copyCmd, stagingBuffer.GetBuffer(), buffer.GetBuffer(), 1, &copyRegion);
+		m_Device.FlushCommandBuffer(copyCmd, m_CopyComputeQueue, true);
+	}
+
+	void HeightMap::CreateFFTTables(uint32_t size)
+	{
+		uint32_t log2Size = 0;
+		while ((1u << log2Size) < size)
+			log2Size++;
+
+		// in double, so every twiddle is the correctly rounded float rather than the GPU's sin / cos
+		std::vector<glm::vec2> twiddles(size / 2);
+		for (uint32_t j = 0; j < size / 2; j++)
+		{
+			double angle = 2.0 * glm::pi<double>() * j / size;
+			twiddles[j] = glm::vec2(static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle)));
+		}
+
+		std::vector<uint32_t> bitReverse(size);
+		for (uint32_t i = 0; i < size; i++)
+		{
+			uint32_t reversed = 0;
+			for (uint32_t bit = 0; bit < log2Size; bit++)
+			{
+				reversed |= ((i >> bit) & 1u) << (log2Size - 1 - bit);
+			}
+			bitReverse[i] = reversed;
+		}
+
+		m_TwiddleBuffer = std::make_shared<Buffer>(
+			m_Device,
+			sizeof(glm::vec2),
+			static_cast<uint32_t>(twiddles.size()),
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		SetDescriptorBufferInfo(m_TwiddleBufferDscInfo, m_TwiddleBuffer->GetBuffer());
+		UploadToBuffer(*m_TwiddleBuffer, twiddles.data(), twiddles.size() * sizeof(glm::vec2));
+
+		m_BitReverseBuffer = std::make_shared<Buffer>(
+			m_Device,
+			sizeof(uint32_t),
+			size,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		SetDescriptorBufferInfo(m_BitReverseBufferDscInfo, m_BitReverseBuffer->GetBuffer());
+		UploadToBuffer(*m_BitReverseBuffer, bitReverse.data(), bitReverse.size() * sizeof(uint32_t));
+	}
+
+	void HeightMap::CreateHeightMap(uint32_t size, const OceanSpectrumParams& params, const DispersionParams& dispersion)
+	{
+		uint32_t elementCount = size * size;
+		std::vector<glm::vec2> htBuffer(size * size * m_OceanPlaneCount);
 
 		// A temporary buffer for textures to write data in compute shaders.
 		std::vector<glm::vec4> tempNormalBuffer(size * size);
 		std::vector<float> tempBubbleBuffer(size * size);
 		
-		TessendorfOceane tOceanManeger(size);
-		tOceanManeger.Generate(h0Buffer);
+		uint32_t oceanSize = TessendorfOceane<>::GetOceanSize(size);
 
-		VkDeviceSize h0BufferSize = static_cast<uint32_t>(h0Buffer.size()) * sizeof(glm::vec2);
+		// Reuse the spectrum of an earlier run if this sea state has been generated before.
+		SpectrumCache spectrumCache;
+		std::vector<glm::vec2> h0Buffer;
+		const glm::vec2* h0Data = spectrumCache.Load(size, oceanSize, oceanSize, params);
+		if (h0Data == nullptr)
+		{
+			h0Buffer.resize(elementCount);
+			GenerateOceanSpectrum(size, params, h0Buffer);
+			spectrumCache.Store(size, oceanSize, oceanSize, params, h0Buffer.data());
+			h0Data = h0Buffer.data();
+		}
+
+		VkDeviceSize h0BufferSize = elementCount * sizeof(glm::vec2);
 		uint32_t elementSize = sizeof(glm::vec2);
 		uint32_t normalElementSize = sizeof(glm::vec4);
 
-		SetupComputeUniformBuffers(tOceanManeger.m_MeshSize, tOceanManeger.m_OceanSizeLx, tOceanManeger.m_OceanSizeLz);
+		SetupComputeUniformBuffers(size, oceanSize, oceanSize);
 
 		Buffer stagingBuffer
 		{
 			m_Device,
 			elementSize,
-			static_cast<uint32_t>(h0Buffer.size()),
+			elementCount,
 			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
 			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
 		};
 
 		stagingBuffer.Map();
-		stagingBuffer.WriteToBuffer((void*)h0Buffer.data());
+		stagingBuffer.WriteToBuffer((void*)h0Data);
+
+		// k, w and 1 / |k| never change, so spectrum.glsl reads them instead of recomputing them
+		m_Dispersion = ResolveDispersion(params, dispersion);
+		BuildWaveTable(size, oceanSize, oceanSize, m_Dispersion, m_Waves);
+
+		m_WaveBuffer = std::make_shared<Buffer>(
+			m_Device,
+			sizeof(WaveVector),
+			elementCount,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		SetDescriptorBufferInfo(m_WaveBufferDscInfo, m_WaveBuffer->GetBuffer());
+		UploadToBuffer(*m_WaveBuffer, m_Waves.data(), m_Waves.size() * sizeof(WaveVector));
+
+		CreateFFTTables(size);
+
+		m_HistoryBuffer = std::make_shared<Buffer>(
+			m_Device,
+			GetHistorySlotSize(),
+			m_HistorySlotCount,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			1,
+			VK_SHARING_MODE_CONCURRENT);
+		SetDescriptorBufferInfo(m_HistoryBufferDscInfo, m_HistoryBuffer->GetBuffer());
+
+		m_PhaseBuffer = std::make_shared<Buffer>(
+			m_Device,
+			sizeof(PhaseState),
+			elementCount,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		SetDescriptorBufferInfo(m_PhaseBufferDscInfo, m_PhaseBuffer->GetBuffer());
+		UploadPhases(m_ComputeUBO.deltaT, m_OceanAnimRate * m_StepSeconds);
 
 		// buffer
-		m_H0Buffers.resize(Swapchain::MAX_FRAMES_IN_FLIGHT);
-		m_HtBuffers.resize(Swapchain::MAX_FRAMES_IN_FLIGHT);
-		m_Ht_dmyBuffers.resize(Swapchain::MAX_FRAMES_IN_FLIGHT);
+		m_H0Buffer = std::make_shared<Buffer>(
+			m_Device,
+			elementSize,
+			elementCount,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+		m_HtBuffer = std::make_shared<Buffer>(
+			m_Device,
+			elementSize,
+			static_cast<uint32_t>(htBuffer.size()),
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-		// texture
-		m_OceanNormalTextures.resize(Swapchain::MAX_FRAMES_IN_FLIGHT);
-		m_OceanBubbleTextures.resize(Swapchain::MAX_FRAMES_IN_FLIGHT);
+		m_Ht_dmyBuffer = std::make_shared<Buffer>(
+			m_Device,
+			elementSize,
+			static_cast<uint32_t>(htBuffer.size()),
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-		for (int i = 0; i < Swapchain::MAX_FRAMES_IN_FLIGHT; i++)
-		{
-			m_H0Buffers[i] = std::make_shared<Buffer>(
-				m_Device,
-				elementSize,
-				static_cast<uint32_t>(h0Buffer.size()),
-				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		SetDescriptorBufferInfo(m_H0BufferDscInfo, m_H0Buffer->GetBuffer());
+		SetDescriptorBufferInfo(m_HtBufferDscInfo, m_HtBuffer->GetBuffer());
+		SetDescriptorBufferInfo(m_Ht_dmyBufferDscInfo, m_Ht_dmyBuffer->GetBuffer());
 
-			m_HtBuffers[i] = std::make_shared<Buffer>(
-				m_Device,
-				elementSize,
-				static_cast<uint32_t>(htBuffer.size()),
-				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		// written by the compute queue, sampled by the graphics queue
+		m_OceanNormalTexture = std::make_shared<Texture2D>();
+		m_OceanNormalTexture->CreateTextureFromBuffer(
+			tempNormalBuffer.data(),
+			normalElementSize * elementCount,
+			VK_FORMAT_R32G32B32A32_SFLOAT,
+			size,
+			size,
+			m_Device,
+			m_Device.GetPhDevice(),
+			m_Device.GetGraphicsQueue(),
+			VK_FILTER_LINEAR,
+			VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+			VK_IMAGE_LAYOUT_GENERAL,
+			VK_SHARING_MODE_CONCURRENT
+		);
 
-			m_Ht_dmyBuffers[i] = std::make_shared<Buffer>(
-				m_Device,
-				elementSize,
-				static_cast<uint32_t>(htBuffer.size()),
-				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-
-			m_OceanNormalTextures[i] = std::make_shared<Texture2D>();
-			m_OceanNormalTextures[i]->CreateTextureFromBuffer(
-				tempNormalBuffer.data(),
-				normalElementSize * static_cast<uint32_t>(h0Buffer.size()),
-				VK_FORMAT_R32G32B32A32_SFLOAT,
-				tOceanManeger.m_MeshSize,
-				tOceanManeger.m_MeshSize,
-				m_Device,
-				m_Device.GetPhDevice(),
-				m_Device.GetGraphicsQueue(),
-				VK_FILTER_LINEAR,
-				VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT,
-				VK_IMAGE_LAYOUT_GENERAL
-			);
-
-			m_OceanBubbleTextures[i] = std::make_shared<Texture2D>();
-			m_OceanBubbleTextures[i]->CreateTextureFromBuffer(
-				tempBubbleBuffer.data(),
-				sizeof(float) * static_cast<uint32_t>(h0Buffer.size()),
-				VK_FORMAT_R32_SFLOAT,
-				tOceanManeger.m_MeshSize,
-				tOceanManeger.m_MeshSize,
-				m_Device,
-				m_Device.GetPhDevice(),
-				m_Device.GetGraphicsQueue(),
-				VK_FILTER_LINEAR,
-				VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT,
-				VK_IMAGE_LAYOUT_GENERAL
-			);
-				
-			// Copy from staging buffer
-			VkCommandBuffer copyCmd = m_Device.CreateCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY, true);
-			VkBufferCopy copyRegion = {};
-			copyRegion.size = h0BufferSize;
-
-			vkCmdCopyBuffer(copyCmd, stagingBuffer.GetBuffer(), m_H0Buffers[i]->GetBuffer(), 1, &copyRegion);
-
-			SetDescriptorBufferInfo(m_H0BufferDscInfo, m_H0Buffers[i]->GetBuffer());
-			SetDescriptorBufferInfo(m_HtBufferDscInfo, m_HtBuffers[i]->GetBuffer());
-			SetDescriptorBufferInfo(m_Ht_dmyBufferDscInfo, m_Ht_dmyBuffers[i]->GetBuffer());
-
-			// ő̍ق𐮂
-			VkDeviceSize OceanElementBufferSize = static_cast<uint32_t>(h0Buffer.size() * sizeof(glm::vec2));
-			for (uint32_t index = 0; index < m_OceanElementCount; index++)
-			{
-				SetDescriptorBufferInfo(m_HtBufferDscInfos[index], m_HtBuffers[i]->GetBuffer(), OceanElementBufferSize, OceanElementBufferSize * index);
-				SetDescriptorBufferInfo(m_Ht_dmyBufferDscInfos[index], m_Ht_dmyBuffers[i]->GetBuffer(), OceanElementBufferSize, OceanElementBufferSize * index);
-			}
+		m_OceanBubbleTexture = std::make_shared<Texture2D>();
+		m_OceanBubbleTexture->CreateTextureFromBuffer(
+			tempBubbleBuffer.data(),
+			sizeof(float) * elementCount,
+			VK_FORMAT_R32_SFLOAT,
+			size,
+			size,
+			m_Device,
+			m_Device.GetPhDevice(),
+			m_Device.GetGraphicsQueue(),
+			VK_FILTER_LINEAR,
+			VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT,
+			VK_IMAGE_LAYOUT_GENERAL,
+			VK_SHARING_MODE_CONCURRENT
+		);
 
-			// Execute a transfer barrier to the compute queue, if necessary
-			m_Device.FlushCommandBuffer(copyCmd, m_CopyComputeQueue, true);
-		}
+		// Copy from staging buffer
+		VkCommandBuffer copyCmd = m_Device.CreateCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY, true);
+		VkBufferCopy copyRegion = {};
+		copyRegion.size = h0BufferSize;
+
+		vkCmdCopyBuffer(copyCmd, stagingBuffer.GetBuffer(), m_H0Buffer->GetBuffer(), 1, &copyRegion);
+
+		// Execute a transfer barrier to the compute queue, if necessary
+		m_Device.FlushCommandBuffer(copyCmd, m_CopyComputeQueue, true);
 	}
 
 	void HeightMap::SetDescriptorBufferInfo(VkDescriptorBufferInfo* info, VkBuffer buffer, VkDeviceSize size, VkDeviceSize offset)
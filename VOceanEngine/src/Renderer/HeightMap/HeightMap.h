@@ -3,10 +3,14 @@
 #include "VulkanCore/Device.h"
 #include "Renderer/Buffer.h"
 #include "Renderer/Texture.h"
+#include "Renderer/HeightMap/OceanSpectrum.h"
+#include "Renderer/HeightMap/OceanDispersion.h"
+#include "Renderer/HeightMap/OceanPhase.h"
 
 namespace voe
 {
 	class Texture2D;
+	class OceanLoop;
 	class VOE_API HeightMap
 	{
 	public:
@@ -14,6 +18,11 @@ namespace voe
 		// Number of elements in the structure Ocean
 		static const uint32_t m_OceanElementCount = 5;
 
+		// Every channel of Ocean is Hermitian symmetric, so its FFT is real. Two channels share
+		// one complex transform as A + iB and come back as (a, b) in the x and y components.
+		// Planes of HtBuffers: 0 = (H_y, 0), 1 = (Dx, Dz), 2 = (H_x, H_z)
+		static const uint32_t m_OceanPlaneCount = 3;
+
 		// When changing the number of elements in the structure Ocean,
 		// don't forget to change m_OceanElementCount.
 		struct Ocean
@@ -31,41 +40,106 @@ namespace voe
 			float lamda = 1.0f;
 			uint32_t meshSize = 256;
 			uint32_t OceanSizeLx;
-			uint32_t OceanSizeLz;			
+			uint32_t OceanSizeLz;
+			uint32_t timeStepMode = 0;
+			// pull the phasors back to unit length in this step (TimeStepMode::Incremental)
+			uint32_t renormalize = 0;
 		};
 
+		// Read by testVert to blend the two latest steps in the history buffer, one per frame in flight.
+		struct InterpolationUBO
+		{
+			// weight of the current step, 1 = show it as is
+			float alpha = 1.0f;
+			uint32_t previousSlot = 0;
+			uint32_t currentSlot = 0;
+			// vec2 elements per history slot
+			uint32_t slotStride = 0;
+		};
+
+		// Every step is copied into a slot of the history buffer: planes 0 and 1 of HtBuffers
+		// (H_y, (Dx, Dz)) and then the normal map as vec4. The vertex shader blends the two latest
+		// slots while the next step is written into the third one.
+		static const uint32_t m_HistorySlotCount = 3;
+
 		HeightMap(Device& device, const VkQueue& copyQueue);
 		~HeightMap();
 
 		void AddGraphicsToComputeBarriers(VkCommandBuffer commandBuffer);
 
-		void CreateHeightMap(uint32_t size);
+		// params select the spectrum / spreading models and hold the seed.
+		// dispersion sets w(k) of the wave table (water depth, loop period), see ResolveDispersion for TMA.
+		void CreateHeightMap(uint32_t size, const OceanSpectrumParams& params = {}, const DispersionParams& dispersion = {});
 		void SetupComputeUniformBuffers(uint32_t meshSize, uint32_t lx, uint32_t lz);
 		void CreateComputeUniformBuffers();
 		void UpdateComputeUniformBuffers(float dt, int frameIndex);
 
-		ComputeUBO GetUBO() { return m_ComputeUBO; }
-		VkBuffer GetH0Buffer(uint32_t index) { return m_H0Buffers[index]->GetBuffer(); }
-		VkBuffer GetHtBuffer(uint32_t index) { return m_HtBuffers[index]->GetBuffer(); }
-		VkBuffer GetHt_dmyBuffer(uint32_t index) { return m_Ht_dmyBuffers[index]->GetBuffer(); }
-
-		Texture2D& GetOceanBubbleTexture(uint32_t index) { return *m_OceanBubbleTextures[index]; }
-		VkImage GetOceanBubbleImage(uint32_t index) { return m_OceanBubbleTextures[index]->GetImage(); }
-		VkImageLayout GetOceanBubbleImageLayout(uint32_t index) { return m_OceanBubbleTextures[index]->GetCurrentImageLayout(); }
+		// Incremental advances the ocean by one fixed step of stepSeconds per compute dispatch,
+		// regardless of the frame time. Waits for the compute queue to upload the phases.
+		// With a fixed step rate the step is 1 / rate instead of stepSeconds.
+		void SetTimeStepMode(TimeStepMode mode, float stepSeconds = 1.0f / 60.0f);
+		TimeStepMode GetTimeStepMode() const { return m_TimeStepMode; }
+
+		// stepsPerSecond > 0 dispatches the compute chain at that rate instead of every frame.
+		// Frames in between blend the two latest steps, so the ocean is shown up to one step late.
+		void SetFixedStepRate(float stepsPerSecond);
+		float GetFixedStepRate() const { return m_FixedStepRate; }
+		// whether the frame of the last UpdateComputeUniformBuffers dispatches a step
+		// (or uploads the next frame of the playback loop)
+		bool IsStepPending() const { return m_StepPending; }
+
+		// Plays a baked loop instead of running the compute chain, nullptr goes back to simulating.
+		// Every step expands the next frame into a slot of the playback staging buffer, to be copied into
+		// the history slot of the same index, and its Jacobian for OceanBubbleImage, so the foam moves with
+		// the loop instead of keeping the last simulated step. Steps come at GetFrameCount() / GetPeriod() per unit of
+		// ComputeUBO::deltaT, so the loop runs at the speed of the simulated ocean.
+		// The caller has to make sure the device is idle (the staging buffer is replaced).
+		void SetPlayback(std::shared_ptr<const OceanLoop> loop);
+		bool IsPlaying() const { return m_Playback != nullptr; }
+		// m_HistorySlotCount slots of GetPlaybackSlotSize(), only while playing
+		VkBuffer GetPlaybackStagingBuffer() { return m_PlaybackStagingBuffer->GetBuffer(); }
+		// a history slot followed by the bubble map (one float per texel)
+		VkDeviceSize GetPlaybackSlotSize() const;
+
+		// history slot of the latest step, the pending one if there is one
+		uint32_t GetHistorySlot() const { return m_HistorySlot; }
+		VkDeviceSize GetHistorySlotSize() const;
+		// offset of the normal map within a slot
+		VkDeviceSize GetHistoryNormalOffset() const;
+		const DispersionParams& GetDispersion() const { return m_Dispersion; }
+		// simulation time per second of frame time
+		float GetAnimRate() const { return m_OceanAnimRate; }
 
-		VkImage GetOceanNormalImage(uint32_t index) { return m_OceanNormalTextures[index]->GetImage(); }
+		ComputeUBO GetUBO() { return m_ComputeUBO; }
+		VkBuffer GetH0Buffer() { return m_H0Buffer->GetBuffer(); }
+		VkBuffer GetHtBuffer() { return m_HtBuffer->GetBuffer(); }
+		VkBuffer GetHt_dmyBuffer() { return m_Ht_dmyBuffer->GetBuffer(); }
+		VkBuffer GetPhaseBuffer() { return m_PhaseBuffer->GetBuffer(); }
+		VkBuffer GetWaveBuffer() { return m_WaveBuffer->GetBuffer(); }
+		VkBuffer GetHistoryBuffer() { return m_HistoryBuffer->GetBuffer(); }
+
+		Texture2D& GetOceanBubbleTexture() { return *m_OceanBubbleTexture; }
+		VkImage GetOceanBubbleImage() { return m_OceanBubbleTexture->GetImage(); }
+		VkImageLayout GetOceanBubbleImageLayout() { return m_OceanBubbleTexture->GetCurrentImageLayout(); }
+
+		VkImage GetOceanNormalImage() { return m_OceanNormalTexture->GetImage(); }
 		
+		// ComputeUBO and InterpolationUBO are dynamic uniform buffers with one instance per frame in flight
 		VkDescriptorBufferInfo* GetUniformBufferDscInfo() { return m_UniformBufferDscInfo; }
+		VkDescriptorBufferInfo* GetInterpolationBufferDscInfo() { return m_InterpolationBufferDscInfo; }
+		uint32_t GetUniformBufferOffset(uint32_t frameIndex);
+		uint32_t GetInterpolationBufferOffset(uint32_t frameIndex);
+		VkDescriptorBufferInfo* GetHistoryBufferDscInfo() { return m_HistoryBufferDscInfo; }
 		VkDescriptorBufferInfo* GetH0BufferDscInfo() { return m_H0BufferDscInfo; }
 		VkDescriptorBufferInfo* GetHtBufferDscInfo() { return m_HtBufferDscInfo; }
 		VkDescriptorBufferInfo* GetHt_dmyBufferDscInfo() { return m_Ht_dmyBufferDscInfo; }
+		VkDescriptorBufferInfo* GetPhaseBufferDscInfo() { return m_PhaseBufferDscInfo; }
+		VkDescriptorBufferInfo* GetWaveBufferDscInfo() { return m_WaveBufferDscInfo; }
+		VkDescriptorBufferInfo* GetTwiddleBufferDscInfo() { return m_TwiddleBufferDscInfo; }
+		VkDescriptorBufferInfo* GetBitReverseBufferDscInfo() { return m_BitReverseBufferDscInfo; }
 
-		VkDescriptorImageInfo* GetOceanBubbleTextureDscInfo() { return m_OceanBubbleTextures[0]->GetDescriptorImageInfo(); }
-		VkDescriptorImageInfo* GetOceanNormalTextureDscInfo() { return m_OceanNormalTextures[0]->GetDescriptorImageInfo(); }
-
-		// ő̍ق𐮂
-		VkDescriptorBufferInfo* GetHtBufferDscInfos(uint32_t index) { return m_HtBufferDscInfos[index]; }
-		VkDescriptorBufferInfo* GetHt_dmyBufferDscInfos(uint32_t index) { return m_Ht_dmyBufferDscInfos[index]; }
+		VkDescriptorImageInfo* GetOceanBubbleTextureDscInfo() { return m_OceanBubbleTexture->GetDescriptorImageInfo(); }
+		VkDescriptorImageInfo* GetOceanNormalTextureDscInfo() { return m_OceanNormalTexture->GetDescriptorImageInfo(); }
 		
 	private:
 		void SetDescriptorBufferInfo(
@@ -74,30 +148,77 @@ namespace voe
 			VkDeviceSize size = VK_WHOLE_SIZE,
 			VkDeviceSize offset = 0);
 
+		// Phasors at time with steps of dt into m_PhaseBuffer.
+		void UploadPhases(float time, float dt);
+		// Copies size bytes into a device local buffer through a staging buffer.
+		void UploadToBuffer(Buffer& buffer, const void* data, VkDeviceSize size);
+		// Twiddles and bit reversed indices of FFT.comp for a transform of size points.
+		void CreateFFTTables(uint32_t size);
+
 		Device& m_Device;
 		const VkQueue& m_CopyComputeQueue;
 
 		ComputeUBO m_ComputeUBO;
 
-		std::vector<std::shared_ptr<Buffer>> m_UniformBuffers;
+		std::shared_ptr<Buffer> m_UniformBuffer;
 		VkDescriptorBufferInfo* m_UniformBufferDscInfo = VK_NULL_HANDLE;
 
-		// storage buffers
-		std::vector<std::shared_ptr<Buffer>> m_H0Buffers;
+		InterpolationUBO m_InterpolationUBO;
+		std::shared_ptr<Buffer> m_InterpolationBuffer;
+		VkDescriptorBufferInfo* m_InterpolationBufferDscInfo = VK_NULL_HANDLE;
+
+		// storage buffers, one of each for all frames in flight like the descriptor sets that bind them
+		std::shared_ptr<Buffer> m_H0Buffer;
 		VkDescriptorBufferInfo* m_H0BufferDscInfo = VK_NULL_HANDLE;
 
-		std::vector<std::shared_ptr<Buffer>> m_HtBuffers;
+		std::shared_ptr<Buffer> m_HtBuffer;
 		VkDescriptorBufferInfo* m_HtBufferDscInfo = VK_NULL_HANDLE;
 
-		std::vector<std::shared_ptr<Buffer>> m_Ht_dmyBuffers;
+		std::shared_ptr<Buffer> m_Ht_dmyBuffer;
 		VkDescriptorBufferInfo* m_Ht_dmyBufferDscInfo = VK_NULL_HANDLE;
 
-		std::vector<std::shared_ptr<Texture2D>> m_OceanBubbleTextures;
-		std::vector<std::shared_ptr<Texture2D>> m_OceanNormalTextures;
-		
-		std::array<VkDescriptorBufferInfo*, m_OceanElementCount> m_HtBufferDscInfos;
-		std::array<VkDescriptorBufferInfo*, m_OceanElementCount> m_Ht_dmyBufferDscInfos;
+		// PhaseState per bin, read and written by every spectrum dispatch, so only one for all frames
+		std::shared_ptr<Buffer> m_PhaseBuffer;
+		VkDescriptorBufferInfo* m_PhaseBufferDscInfo = VK_NULL_HANDLE;
+
+		// WaveVector per bin, constant after CreateHeightMap
+		std::shared_ptr<Buffer> m_WaveBuffer;
+		VkDescriptorBufferInfo* m_WaveBufferDscInfo = VK_NULL_HANDLE;
+		// kept for the phases of SetTimeStepMode
+		std::vector<WaveVector> m_Waves;
+		DispersionParams m_Dispersion;
+
+		// FFT.comp tables, constant after CreateHeightMap: (cos, sin)(2 pi j / N) for j < N / 2
+		// and the bit reversal of every index of a row
+		std::shared_ptr<Buffer> m_TwiddleBuffer;
+		VkDescriptorBufferInfo* m_TwiddleBufferDscInfo = VK_NULL_HANDLE;
+		std::shared_ptr<Buffer> m_BitReverseBuffer;
+		VkDescriptorBufferInfo* m_BitReverseBufferDscInfo = VK_NULL_HANDLE;
+
+		// m_HistorySlotCount slots, written on the compute queue and read on the graphics queue
+		std::shared_ptr<Buffer> m_HistoryBuffer;
+		VkDescriptorBufferInfo* m_HistoryBufferDscInfo = VK_NULL_HANDLE;
+
+		std::shared_ptr<Texture2D> m_OceanBubbleTexture;
+		std::shared_ptr<Texture2D> m_OceanNormalTexture;
 
 		const float m_OceanAnimRate = 3.0f;
+
+		TimeStepMode m_TimeStepMode = TimeStepMode::Absolute;
+		float m_StepSeconds = 1.0f / 60.0f;
+		uint32_t m_StepCount = 0;
+
+		float m_FixedStepRate = 0.0f;
+		// frame time since the last step (fixed step rate)
+		float m_StepAccumulator = 0.0f;
+		bool m_StepPending = false;
+		uint32_t m_HistorySlot = 0;
+		uint32_t m_PublishedSteps = 0;
+
+		std::shared_ptr<const OceanLoop> m_Playback;
+		// host visible, written by the CPU, one slot per history slot
+		std::shared_ptr<Buffer> m_PlaybackStagingBuffer;
+		float m_PlaybackStepRate = 0.0f;
+		uint32_t m_PlaybackFrame = 0;
 	};
 }
\ No newline at end of file
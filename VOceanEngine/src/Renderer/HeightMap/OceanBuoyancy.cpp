@@ -0,0 +1,307 @@
+#include "PreCompileHeader.h"
+#include "OceanBuoyancy.h"
+
+#include "Renderer/GameObject.h"
+#include "Renderer/HeightMap/OceanHeightQuery.h"
+
+namespace voe
+{
+    namespace
+    {
+        struct Quat
+        {
+            float W, X, Y, Z;
+
+            Quat operator*(const Quat& b) const
+            {
+                return {
+                    W * b.W - X * b.X - Y * b.Y - Z * b.Z,
+                    W * b.X + X * b.W + Y * b.Z - Z * b.Y,
+                    W * b.Y - X * b.Z + Y * b.W + Z * b.X,
+                    W * b.Z + X * b.Y - Y * b.X + Z * b.W };
+            }
+
+            glm::vec3 Rotate(glm::vec3 v) const
+            {
+                // v + 2w (q x v) + 2 q x (q x v)
+                glm::vec3 q(X, Y, Z);
+                glm::vec3 t = 2.0f * glm::cross(q, v);
+                return v + W * t + glm::cross(q, t);
+            }
+
+            glm::vec3 RotateInverse(glm::vec3 v) const
+            {
+                return Quat{ W, -X, -Y, -Z }.Rotate(v);
+            }
+
+            // Tait-Bryan angles of TransformComponent: R = Ry * Rx * Rz
+            static Quat FromEulerYXZ(glm::vec3 angles)
+            {
+                Quat qy{ std::cos(angles.y * 0.5f), 0.0f, std::sin(angles.y * 0.5f), 0.0f };
+                Quat qx{ std::cos(angles.x * 0.5f), std::sin(angles.x * 0.5f), 0.0f, 0.0f };
+                Quat qz{ std::cos(angles.z * 0.5f), 0.0f, 0.0f, std::sin(angles.z * 0.5f) };
+                return qy * qx * qz;
+            }
+
+            glm::vec3 ToEulerYXZ() const
+            {
+                // the matrix elements R(row, col) the angles are read from
+                float r02 = 2.0f * (X * Z + W * Y);
+                float r12 = 2.0f * (Y * Z - W * X);
+                float r22 = 1.0f - 2.0f * (X * X + Y * Y);
+                float r10 = 2.0f * (X * Y + W * Z);
+                float r11 = 1.0f - 2.0f * (X * X + Z * Z);
+
+                return glm::vec3(
+                    std::asin(std::clamp(-r12, -1.0f, 1.0f)),
+                    std::atan2(r02, r22),
+                    std::atan2(r10, r11));
+            }
+        };
+
+        template<typename T>
+        void EraseAt(std::vector<T>& values, uint32_t index, uint32_t count = 1)
+        {
+            values.erase(values.begin() + index, values.begin() + index + count);
+        }
+    }
+
+    OceanBuoyancy::OceanBuoyancy(const BuoyancyParams& params, uint32_t threadCount)
+        : m_Params(params), m_ThreadPool(threadCount)
+    {
+    }
+
+    uint32_t OceanBuoyancy::AddBody(TransformComponent& transform, float mass, const BuoyancyPoint* points, uint32_t pointCount)
+    {
+        if (pointCount == 0 || mass <= 0.0f)
+        {
+            throw std::runtime_error("OceanBuoyancy: a body needs a positive mass and at least one sample point");
+        }
+
+        Quat orientation = Quat::FromEulerYXZ(transform.Rotation);
+
+        // point masses, plus a cube of PointHeight around every point so that the inertia is never zero
+        float pointMass = mass / pointCount;
+        glm::vec3 inertia(pointMass * pointCount * m_Params.PointHeight * m_Params.PointHeight / 6.0f);
+        for (uint32_t i = 0; i < pointCount; i++)
+        {
+            glm::vec3 r = points[i].Offset;
+            inertia = inertia + pointMass * glm::vec3(r.y * r.y + r.z * r.z, r.x * r.x + r.z * r.z, r.x * r.x + r.y * r.y);
+        }
+
+        uint32_t id = m_NextBodyId++;
+        m_BodyIndices[id] = GetBodyCount();
+        m_BodyIds.push_back(id);
+
+        m_Transforms.push_back(&transform);
+        m_PositionX.push_back(transform.Translation.x);
+        m_PositionY.push_back(transform.Translation.y);
+        m_PositionZ.push_back(transform.Translation.z);
+        m_VelocityX.push_back(0.0f);
+        m_VelocityY.push_back(0.0f);
+        m_VelocityZ.push_back(0.0f);
+        m_AngularX.push_back(0.0f);
+        m_AngularY.push_back(0.0f);
+        m_AngularZ.push_back(0.0f);
+        m_OrientationW.push_back(orientation.W);
+        m_OrientationX.push_back(orientation.X);
+        m_OrientationY.push_back(orientation.Y);
+        m_OrientationZ.push_back(orientation.Z);
+        m_InvMass.push_back(1.0f / mass);
+        m_InvInertiaX.push_back(1.0f / inertia.x);
+        m_InvInertiaY.push_back(1.0f / inertia.y);
+        m_InvInertiaZ.push_back(1.0f / inertia.z);
+        m_PointBegin.push_back(GetPointCount());
+        m_PointCount.push_back(pointCount);
+
+        for (uint32_t i = 0; i < pointCount; i++)
+        {
+            m_PointOffsetX.push_back(points[i].Offset.x);
+            m_PointOffsetY.push_back(points[i].Offset.y);
+            m_PointOffsetZ.push_back(points[i].Offset.z);
+            m_PointVolume.push_back(points[i].Volume);
+        }
+
+        m_QueryPositions.resize(GetPointCount());
+        m_WaterHeights.resize(GetPointCount());
+        return id;
+    }
+
+    void OceanBuoyancy::RemoveBody(uint32_t id)
+    {
+        auto it = m_BodyIndices.find(id);
+        if (it == m_BodyIndices.end())
+            return;
+
+        // keeps the order, the points of a chunk of bodies have to stay contiguous
+        uint32_t index = it->second;
+        uint32_t pointBegin = m_PointBegin[index];
+        uint32_t pointCount = m_PointCount[index];
+        m_BodyIndices.erase(it);
+
+        for (uint32_t i = index + 1; i < GetBodyCount(); i++)
+        {
+            m_BodyIndices[m_BodyIds[i]] = i - 1;
+            m_PointBegin[i] -= pointCount;
+        }
+
+        EraseAt(m_BodyIds, index);
+        EraseAt(m_Transforms, index);
+        EraseAt(m_PositionX, index);
+        EraseAt(m_PositionY, index);
+        EraseAt(m_PositionZ, index);
+        EraseAt(m_VelocityX, index);
+        EraseAt(m_VelocityY, index);
+        EraseAt(m_VelocityZ, index);
+        EraseAt(m_AngularX, index);
+        EraseAt(m_AngularY, index);
+        EraseAt(m_AngularZ, index);
+        EraseAt(m_OrientationW, index);
+        EraseAt(m_OrientationX, index);
+        EraseAt(m_OrientationY, index);
+        EraseAt(m_OrientationZ, index);
+        EraseAt(m_InvMass, index);
+        EraseAt(m_InvInertiaX, index);
+        EraseAt(m_InvInertiaY, index);
+        EraseAt(m_InvInertiaZ, index);
+        EraseAt(m_PointBegin, index);
+        EraseAt(m_PointCount, index);
+
+        EraseAt(m_PointOffsetX, pointBegin, pointCount);
+        EraseAt(m_PointOffsetY, pointBegin, pointCount);
+        EraseAt(m_PointOffsetZ, pointBegin, pointCount);
+        EraseAt(m_PointVolume, pointBegin, pointCount);
+        m_QueryPositions.resize(GetPointCount());
+        m_WaterHeights.resize(GetPointCount());
+    }
+
+    void OceanBuoyancy::Clear()
+    {
+        while (!m_BodyIds.empty())
+        {
+            RemoveBody(m_BodyIds.back());
+        }
+    }
+
+    glm::vec3 OceanBuoyancy::GetVelocity(uint32_t id) const
+    {
+        uint32_t index = m_BodyIndices.at(id);
+        return glm::vec3(m_VelocityX[index], m_VelocityY[index], m_VelocityZ[index]);
+    }
+
+    void OceanBuoyancy::SetVelocity(uint32_t id, glm::vec3 velocity)
+    {
+        uint32_t index = m_BodyIndices.at(id);
+        m_VelocityX[index] = velocity.x;
+        m_VelocityY[index] = velocity.y;
+        m_VelocityZ[index] = velocity.z;
+    }
+
+    void OceanBuoyancy::Step(const OceanHeightQuery& query, float dt)
+    {
+        if (m_Transforms.empty())
+            return;
+
+        m_ThreadPool.ParallelFor(GetBodyCount(), BatchSize, [&](uint32_t begin, uint32_t end, uint32_t)
+        {
+            StepBodies(query, dt, begin, end);
+        });
+    }
+
+    void OceanBuoyancy::StepBodies(const OceanHeightQuery& query, float dt, uint32_t begin, uint32_t end)
+    {
+        // horizontal positions of all points of the chunk, then one batch of queries for them
+        for (uint32_t body = begin; body < end; body++)
+        {
+            Quat orientation{ m_OrientationW[body], m_OrientationX[body], m_OrientationY[body], m_OrientationZ[body] };
+            uint32_t pointEnd = m_PointBegin[body] + m_PointCount[body];
+            for (uint32_t point = m_PointBegin[body]; point < pointEnd; point++)
+            {
+                glm::vec3 r = orientation.Rotate(glm::vec3(m_PointOffsetX[point], m_PointOffsetY[point], m_PointOffsetZ[point]));
+                m_QueryPositions[point] = glm::vec2(m_PositionX[body] + r.x, m_PositionZ[body] + r.z);
+            }
+        }
+
+        uint32_t pointBegin = m_PointBegin[begin];
+        uint32_t pointCount = m_PointBegin[end - 1] + m_PointCount[end - 1] - pointBegin;
+        query.QueryHeightsSerial(&m_QueryPositions[pointBegin], &m_WaterHeights[pointBegin], pointCount);
+
+        const float buoyancyPerVolume = m_Params.WaterDensity * m_Params.Gravity;
+        const float invPointHeight = 1.0f / m_Params.PointHeight;
+
+        for (uint32_t body = begin; body < end; body++)
+        {
+            Quat orientation{ m_OrientationW[body], m_OrientationX[body], m_OrientationY[body], m_OrientationZ[body] };
+            glm::vec3 position(m_PositionX[body], m_PositionY[body], m_PositionZ[body]);
+            glm::vec3 velocity(m_VelocityX[body], m_VelocityY[body], m_VelocityZ[body]);
+            glm::vec3 angular(m_AngularX[body], m_AngularY[body], m_AngularZ[body]);
+
+            float mass = 1.0f / m_InvMass[body];
+            float pointMass = mass / m_PointCount[body];
+
+            glm::vec3 force(0.0f, mass * m_Params.Gravity, 0.0f);
+            glm::vec3 torque(0.0f);
+            float submerged = 0.0f;
+
+            uint32_t pointEnd = m_PointBegin[body] + m_PointCount[body];
+            for (uint32_t point = m_PointBegin[body]; point < pointEnd; point++)
+            {
+                glm::vec3 r = orientation.Rotate(glm::vec3(m_PointOffsetX[point], m_PointOffsetY[point], m_PointOffsetZ[point]));
+
+                // +y is down, so the depth grows with y
+                float depth = position.y + r.y - m_WaterHeights[point];
+                float fraction = std::clamp(depth * invPointHeight + 0.5f, 0.0f, 1.0f);
+                if (fraction <= 0.0f)
+                    continue;
+
+                glm::vec3 pointVelocity = velocity + glm::cross(angular, r);
+                glm::vec3 pointForce(0.0f, -buoyancyPerVolume * m_PointVolume[point] * fraction, 0.0f);
+                pointForce = pointForce - (m_Params.LinearDrag * fraction * pointMass) * pointVelocity;
+
+                force = force + pointForce;
+                torque = torque + glm::cross(r, pointForce);
+                submerged += fraction;
+            }
+
+            // semi-implicit Euler, the inertia is diagonal in body space
+            velocity = velocity + (dt * m_InvMass[body]) * force;
+
+            glm::vec3 localTorque = orientation.RotateInverse(torque);
+            glm::vec3 localAcceleration(
+                localTorque.x * m_InvInertiaX[body],
+                localTorque.y * m_InvInertiaY[body],
+                localTorque.z * m_InvInertiaZ[body]);
+            angular = angular + dt * orientation.Rotate(localAcceleration);
+            angular = angular * (1.0f / (1.0f + m_Params.AngularDrag * (submerged / m_PointCount[body]) * dt));
+
+            position = position + dt * velocity;
+
+            Quat spin{ 0.0f, angular.x, angular.y, angular.z };
+            Quat delta = spin * orientation;
+            orientation.W += 0.5f * dt * delta.W;
+            orientation.X += 0.5f * dt * delta.X;
+            orientation.Y += 0.5f * dt * delta.Y;
+            orientation.Z += 0.5f * dt * delta.Z;
+            float invLength = 1.0f / std::sqrt(
+                orientation.W * orientation.W + orientation.X * orientation.X + orientation.Y * orientation.Y + orientation.Z * orientation.Z);
+
+            m_PositionX[body] = position.x;
+            m_PositionY[body] = position.y;
+            m_PositionZ[body] = position.z;
+            m_VelocityX[body] = velocity.x;
+            m_VelocityY[body] = velocity.y;
+            m_VelocityZ[body] = velocity.z;
+            m_AngularX[body] = angular.x;
+            m_AngularY[body] = angular.y;
+            m_AngularZ[body] = angular.z;
+            m_OrientationW[body] = orientation.W * invLength;
+            m_OrientationX[body] = orientation.X * invLength;
+            m_OrientationY[body] = orientation.Y * invLength;
+            m_OrientationZ[body] = orientation.Z * invLength;
+
+            TransformComponent& transform = *m_Transforms[body];
+            transform.Translation = position;
+            transform.Rotation = Quat{ m_OrientationW[body], m_OrientationX[body], m_OrientationY[body], m_OrientationZ[body] }.ToEulerYXZ();
+        }
+    }
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "VOceanEngine/ThreadPool.h"
+
+#include <unordered_map>
+
+namespace voe
+{
+    class OceanHeightQuery;
+    struct TransformComponent;
+
+    struct BuoyancyParams
+    {
+        // along +y
+        float Gravity = 9.81f;
+        float WaterDensity = 1025.0f;
+        // vertical extent of a sample point, it is partly submerged within +-PointHeight / 2
+        float PointHeight = 1.0f;
+        // drag at a submerged point, per second and kg of the point's share of the mass
+        float LinearDrag = 1.0f;
+        float AngularDrag = 0.5f;
+    };
+
+    struct BuoyancyPoint
+    {
+        // in body space, scaled like the model
+        glm::vec3 Offset{};
+        float Volume = 0.0f;
+    };
+
+    // Rigid bodies floating on the CPU ocean.
+    // Every body is a set of sample points, each displacing Volume when fully under water. Per fixed tick
+    // Step looks up the water height under every point, applies buoyancy, drag at the points and
+    // gravity, integrates the bodies and writes their TransformComponent.
+    // Bodies and points are kept as structure of arrays with the points of a body next to each other,
+    // so a chunk of bodies is one contiguous batch of height queries.
+    // The y axis points down (see CameraController), a point is under water when its y is larger than
+    // the water height. Positions are in world space with the ocean plane at the origin.
+    class VOE_API OceanBuoyancy
+    {
+    public:
+        // bodies per ParallelFor chunk
+        static constexpr uint32_t BatchSize = 64;
+
+        // threadCount is passed to the ThreadPool of Step.
+        explicit OceanBuoyancy(const BuoyancyParams& params = {}, uint32_t threadCount = 0);
+        ~OceanBuoyancy() = default;
+
+        OceanBuoyancy(const OceanBuoyancy&) = delete;
+        OceanBuoyancy& operator=(const OceanBuoyancy&) = delete;
+
+        // Starts from the current Translation and Rotation of transform, which is written by every Step
+        // until the body is removed and has to stay valid until then. Returns the id of the body.
+        // The inertia follows from spreading the mass evenly over the points.
+        uint32_t AddBody(TransformComponent& transform, float mass, const BuoyancyPoint* points, uint32_t pointCount);
+        void RemoveBody(uint32_t id);
+        void Clear();
+
+        uint32_t GetBodyCount() const { return static_cast<uint32_t>(m_Transforms.size()); }
+        uint32_t GetPointCount() const { return static_cast<uint32_t>(m_PointVolume.size()); }
+        void SetParams(const BuoyancyParams& params) { m_Params = params; }
+        const BuoyancyParams& GetParams() const { return m_Params; }
+
+        glm::vec3 GetVelocity(uint32_t id) const;
+        void SetVelocity(uint32_t id, glm::vec3 velocity);
+
+        // One fixed tick of dt seconds. Returns when every transform is written.
+        void Step(const OceanHeightQuery& query, float dt);
+
+    private:
+        void StepBodies(const OceanHeightQuery& query, float dt, uint32_t begin, uint32_t end);
+
+        BuoyancyParams m_Params;
+
+        // bodies
+        std::vector<TransformComponent*> m_Transforms;
+        std::vector<float> m_PositionX, m_PositionY, m_PositionZ;
+        std::vector<float> m_VelocityX, m_VelocityY, m_VelocityZ;
+        std::vector<float> m_AngularX, m_AngularY, m_AngularZ;
+        // orientation quaternion
+        std::vector<float> m_OrientationW, m_OrientationX, m_OrientationY, m_OrientationZ;
+        std::vector<float> m_InvMass;
+        // diagonal of the inverse inertia in body space
+        std::vector<float> m_InvInertiaX, m_InvInertiaY, m_InvInertiaZ;
+        std::vector<uint32_t> m_PointBegin;
+        std::vector<uint32_t> m_PointCount;
+
+        // points, in the order of the bodies
+        std::vector<float> m_PointOffsetX, m_PointOffsetY, m_PointOffsetZ;
+        std::vector<float> m_PointVolume;
+        // per tick: horizontal world position of every point and the water height there
+        std::vector<glm::vec2> m_QueryPositions;
+        std::vector<float> m_WaterHeights;
+
+        std::vector<uint32_t> m_BodyIds;
+        std::unordered_map<uint32_t, uint32_t> m_BodyIndices;
+        uint32_t m_NextBodyId = 0;
+
+        ThreadPool m_ThreadPool;
+    };
+}
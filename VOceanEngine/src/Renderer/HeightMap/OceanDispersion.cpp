@@ -0,0 +1,63 @@
+#include "PreCompileHeader.h"
+#include "OceanDispersion.h"
+
+namespace voe
+{
+    DispersionParams ResolveDispersion(const OceanSpectrumParams& spectrum, const DispersionParams& dispersion)
+    {
+        DispersionParams result = dispersion;
+        if (spectrum.Spectrum != SpectrumModel::TMA)
+        {
+            return result;
+        }
+
+        if (dispersion.Depth > 0.0f && dispersion.Depth != spectrum.Depth)
+        {
+            throw std::runtime_error("ResolveDispersion: dispersion depth differs from the TMA spectrum depth");
+        }
+        result.Depth = spectrum.Depth;
+        result.G = spectrum.G;
+        return result;
+    }
+
+    float EvaluateDispersion(float k, const DispersionParams& params)
+    {
+        float w = params.Depth > 0.0f
+            ? std::sqrt(params.G * k * std::tanh(k * params.Depth))
+            : std::sqrt(params.G * k);
+
+        if (params.LoopPeriod > 0.0f)
+        {
+            float w0 = 2.0f * glm::pi<float>() / params.LoopPeriod;
+            w = std::floor(w / w0) * w0;
+        }
+        return w;
+    }
+
+    void BuildWaveTable(
+        uint32_t meshSize,
+        uint32_t oceanSizeLx,
+        uint32_t oceanSizeLz,
+        const DispersionParams& params,
+        std::vector<WaveVector>& waves)
+    {
+        const int N = static_cast<int>(meshSize);
+        const float PI = glm::pi<float>();
+
+        waves.resize(meshSize * meshSize);
+
+        for (uint32_t y = 0; y < meshSize; y++)
+        {
+            for (uint32_t x = 0; x < meshSize; x++)
+            {
+                WaveVector& wave = waves[y * meshSize + x];
+                wave.Kx = (-N / 2.0f + x) * (2.0f * PI / oceanSizeLx);
+                wave.Kz = (-N / 2.0f + y) * (2.0f * PI / oceanSizeLz);
+
+                float k_len = std::sqrt(wave.Kx * wave.Kx + wave.Kz * wave.Kz);
+                wave.Omega = EvaluateDispersion(k_len, params);
+                wave.InvLength = k_len != 0.0f ? 1.0f / k_len : 0.0f;
+            }
+        }
+    }
+}
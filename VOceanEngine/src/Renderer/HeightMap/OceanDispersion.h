@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Renderer/HeightMap/OceanSpectrum.h"
+
+namespace voe
+{
+    // Dispersion relation w(k) of the time evolution.
+    struct DispersionParams
+    {
+        // gravitational constant
+        float G = 9.81f;
+        // water depth [m], 0 = deep water with w = sqrt(g k), otherwise w = sqrt(g k tanh(k h))
+        // With SpectrumModel::TMA it has to match OceanSpectrumParams::Depth, see ResolveDispersion.
+        float Depth = 0.0f;
+        // > 0 rounds w down to multiples of 2 pi / LoopPeriod, so the whole ocean repeats
+        // exactly every LoopPeriod (in units of ComputeUBO::deltaT)
+        float LoopPeriod = 0.0f;
+    };
+
+    // One element of WaveBuffer (a vec4 in spectrum.glsl). Depends only on the grid and
+    // DispersionParams, so it is built once instead of in every spectrum step.
+    struct WaveVector
+    {
+        float Kx;
+        float Kz;
+        float Omega;
+        // 1 / |k|, 0 for k = 0
+        float InvLength;
+    };
+
+    // The dispersion the ocean generated from spectrum is evolved with.
+    // TMA builds h0 with the finite depth w(k), so the depth and g are taken from spectrum there
+    // (a different non-zero dispersion.Depth throws). Other models keep dispersion as it is.
+    VOE_API DispersionParams ResolveDispersion(const OceanSpectrumParams& spectrum, const DispersionParams& dispersion);
+
+    VOE_API float EvaluateDispersion(float k, const DispersionParams& params);
+
+    // Wave vectors of every bin of the centered spectrum, (-N/2 + x) * 2 pi / Lx like spectrum.glsl.
+    // waves is resized to meshSize * meshSize.
+    VOE_API void BuildWaveTable(
+        uint32_t meshSize,
+        uint32_t oceanSizeLx,
+        uint32_t oceanSizeLz,
+        const DispersionParams& params,
+        std::vector<WaveVector>& waves);
+}
@@ -0,0 +1,289 @@
+#include "PreCompileHeader.h"
+#include "OceanHeightPyramid.h"
+
+#include "OceanHeightQuery.h"
+
+namespace voe
+{
+    namespace
+    {
+        // steps t past a cell boundary before the next cell is looked up, in grid cells
+        constexpr float BoundaryNudge = 1e-3f;
+    }
+
+    OceanHeightPyramid::OceanHeightPyramid(uint32_t threadCount)
+        : m_ThreadPool(threadCount)
+    {
+    }
+
+    void OceanHeightPyramid::Build(OceanHeightQuery& query)
+    {
+        if (query.IsEmpty())
+            return;
+
+        uint32_t meshSize = query.GetMeshSize();
+        uint32_t elementCount = meshSize * meshSize;
+        m_CellSize = query.GetOceanSize() / meshSize;
+
+        if (m_MeshSize != meshSize)
+        {
+            m_MeshSize = meshSize;
+            m_MeshMask = meshSize - 1;
+
+            m_Heights.resize(elementCount);
+            m_SamplePositions.resize(elementCount);
+
+            m_Levels.clear();
+            for (uint32_t size = meshSize; size > 0; size >>= 1)
+            {
+                m_Levels.emplace_back(size * size);
+            }
+        }
+
+        for (uint32_t x = 0; x < meshSize; x++)
+        {
+            for (uint32_t z = 0; z < meshSize; z++)
+            {
+                m_SamplePositions[x * meshSize + z] = glm::vec2(x, z) * m_CellSize;
+            }
+        }
+        query.QueryHeights(m_SamplePositions.data(), m_Heights.data(), elementCount);
+
+        // level 0: the four corners of every cell, wrapping at the tile edge
+        std::vector<glm::vec2>& base = m_Levels[0];
+        for (uint32_t x = 0; x < meshSize; x++)
+        {
+            for (uint32_t z = 0; z < meshSize; z++)
+            {
+                float h00 = GetHeight(x, z);
+                float h01 = GetHeight(x, z + 1);
+                float h10 = GetHeight(x + 1, z);
+                float h11 = GetHeight(x + 1, z + 1);
+
+                base[x * meshSize + z] = glm::vec2(
+                    std::min(std::min(h00, h01), std::min(h10, h11)),
+                    std::max(std::max(h00, h01), std::max(h10, h11)));
+            }
+        }
+
+        for (size_t level = 1; level < m_Levels.size(); level++)
+        {
+            const std::vector<glm::vec2>& below = m_Levels[level - 1];
+            std::vector<glm::vec2>& cells = m_Levels[level];
+            uint32_t belowSize = meshSize >> (level - 1);
+            uint32_t size = meshSize >> level;
+
+            for (uint32_t x = 0; x < size; x++)
+            {
+                for (uint32_t z = 0; z < size; z++)
+                {
+                    const glm::vec2& b00 = below[(2 * x) * belowSize + 2 * z];
+                    const glm::vec2& b01 = below[(2 * x) * belowSize + 2 * z + 1];
+                    const glm::vec2& b10 = below[(2 * x + 1) * belowSize + 2 * z];
+                    const glm::vec2& b11 = below[(2 * x + 1) * belowSize + 2 * z + 1];
+
+                    cells[x * size + z] = glm::vec2(
+                        std::min(std::min(b00.x, b01.x), std::min(b10.x, b11.x)),
+                        std::max(std::max(b00.y, b01.y), std::max(b10.y, b11.y)));
+                }
+            }
+        }
+    }
+
+    glm::vec2 OceanHeightPyramid::GetBounds(uint32_t level, uint32_t x, uint32_t z) const
+    {
+        uint32_t size = m_MeshSize >> level;
+        return m_Levels[level][x * size + z];
+    }
+
+    float OceanHeightPyramid::GetHeight(int32_t x, int32_t z) const
+    {
+        // two's complement & mask wraps negative cells as well
+        uint32_t wx = static_cast<uint32_t>(x) & m_MeshMask;
+        uint32_t wz = static_cast<uint32_t>(z) & m_MeshMask;
+        return m_Heights[wx * m_MeshSize + wz];
+    }
+
+    bool OceanHeightPyramid::IntersectCell(
+        int32_t x, int32_t z, glm::vec3 origin, glm::vec3 direction, float t0, float t1, float& t) const
+    {
+        float h00 = GetHeight(x, z);
+        float h01 = GetHeight(x, z + 1);
+        float h10 = GetHeight(x + 1, z);
+        float h11 = GetHeight(x + 1, z + 1);
+
+        // bilinear patch h00 + k1 * u + k2 * v + k3 * u * v over the cell
+        float k1 = h10 - h00;
+        float k2 = h01 - h00;
+        float k3 = h00 - h10 - h01 + h11;
+
+        // u, v and y along s = t - t0, in cells and world units
+        float invCellSize = 1.0f / m_CellSize;
+        float u0 = (origin.x + direction.x * t0) * invCellSize - x;
+        float v0 = (origin.z + direction.z * t0) * invCellSize - z;
+        float a = direction.x * invCellSize;
+        float b = direction.z * invCellSize;
+        float y0 = origin.y + direction.y * t0;
+
+        // f(s) = y(s) - height(s) = c0 + c1 * s + c2 * s^2, the water starts at f >= 0
+        float c0 = y0 - (h00 + k1 * u0 + k2 * v0 + k3 * u0 * v0);
+        float c1 = direction.y - (k1 * a + k2 * b + k3 * (u0 * b + v0 * a));
+        float c2 = -k3 * a * b;
+        float length = t1 - t0;
+
+        if (c0 >= 0.0f)
+        {
+            t = t0;
+            return true;
+        }
+
+        float best = std::numeric_limits<float>::max();
+        auto consider = [&](float s)
+        {
+            if (s >= 0.0f && s <= length)
+                best = std::min(best, s);
+        };
+
+        if (std::abs(c2) < 1e-8f)
+        {
+            if (c1 > 0.0f)
+                consider(-c0 / c1);
+        }
+        else
+        {
+            float discriminant = c1 * c1 - 4.0f * c2 * c0;
+            if (discriminant >= 0.0f)
+            {
+                // the numerically stable pair of roots
+                float q = -0.5f * (c1 + std::copysign(std::sqrt(discriminant), c1));
+                consider(q / c2);
+                if (q != 0.0f)
+                    consider(c0 / q);
+            }
+        }
+
+        // rounding can lose a root right at the far edge
+        if (best == std::numeric_limits<float>::max() && c0 + (c1 + c2 * length) * length >= 0.0f)
+            best = length;
+
+        if (best == std::numeric_limits<float>::max())
+            return false;
+
+        t = t0 + best;
+        return true;
+    }
+
+    bool OceanHeightPyramid::Raycast(glm::vec3 origin, glm::vec3 direction, float maxDistance, OceanRayHit& hit) const
+    {
+        if (IsEmpty() || glm::length(direction) == 0.0f)
+            return false;
+
+        direction = glm::normalize(direction);
+        const int32_t topLevel = static_cast<int32_t>(m_Levels.size()) - 1;
+        const glm::vec2 globalBounds = m_Levels[topLevel][0];
+        const float invCellSize = 1.0f / m_CellSize;
+
+        auto report = [&](float t)
+        {
+            hit.Distance = t;
+            hit.Position = origin + direction * t;
+            return true;
+        };
+
+        // already under water
+        glm::vec2 grid = glm::vec2(origin.x, origin.z) * invCellSize;
+        glm::vec2 cell = glm::floor(grid);
+        glm::vec2 f = grid - cell;
+        int32_t cx = static_cast<int32_t>(cell.x);
+        int32_t cz = static_cast<int32_t>(cell.y);
+        float surface = glm::mix(
+            glm::mix(GetHeight(cx, cz), GetHeight(cx, cz + 1), f.y),
+            glm::mix(GetHeight(cx + 1, cz), GetHeight(cx + 1, cz + 1), f.y),
+            f.x);
+        if (origin.y >= surface)
+            return report(0.0f);
+
+        // start where the ray gets down to the highest wave
+        float t = 0.0f;
+        if (origin.y < globalBounds.x)
+        {
+            if (direction.y <= 0.0f)
+                return false;
+            t = (globalBounds.x - origin.y) / direction.y;
+        }
+
+        const glm::vec2 gridOrigin = glm::vec2(origin.x, origin.z) * invCellSize;
+        const glm::vec2 gridDirection = glm::vec2(direction.x, direction.z) * invCellSize;
+        const float nudge = BoundaryNudge * m_CellSize;
+
+        int32_t level = topLevel;
+        while (t < maxDistance)
+        {
+            // rising above the highest wave, nothing more to hit
+            if (direction.y <= 0.0f && origin.y + direction.y * t < globalBounds.x)
+                return false;
+
+            // the cell the ray is in just after t
+            float cellSize = static_cast<float>(1 << level);
+            glm::vec2 p = (gridOrigin + gridDirection * (t + nudge)) / cellSize;
+            int32_t x = static_cast<int32_t>(std::floor(p.x));
+            int32_t z = static_cast<int32_t>(std::floor(p.y));
+
+            float exit = maxDistance;
+            if (gridDirection.x > 0.0f)
+                exit = std::min(exit, ((x + 1) * cellSize - gridOrigin.x) / gridDirection.x);
+            else if (gridDirection.x < 0.0f)
+                exit = std::min(exit, (x * cellSize - gridOrigin.x) / gridDirection.x);
+            if (gridDirection.y > 0.0f)
+                exit = std::min(exit, ((z + 1) * cellSize - gridOrigin.y) / gridDirection.y);
+            else if (gridDirection.y < 0.0f)
+                exit = std::min(exit, (z * cellSize - gridOrigin.y) / gridDirection.y);
+            exit = std::max(exit, t);
+
+            // y is linear in t, so the segment is deepest at one of its ends
+            float deepest = origin.y + direction.y * (direction.y > 0.0f ? exit : t);
+            uint32_t levelMask = (m_MeshSize >> level) - 1;
+            float cellMin = GetBounds(level, static_cast<uint32_t>(x) & levelMask, static_cast<uint32_t>(z) & levelMask).x;
+
+            if (deepest < cellMin)
+            {
+                // the whole cell is above the water, skip it and look at coarser cells again
+                t = exit + (exit > t ? 0.0f : nudge);
+                level = std::min(level + 1, topLevel);
+                continue;
+            }
+
+            if (level > 0)
+            {
+                level--;
+                continue;
+            }
+
+            float hitDistance;
+            if (IntersectCell(x, z, origin, direction, t, exit, hitDistance))
+                return report(hitDistance);
+
+            t = exit + (exit > t ? 0.0f : nudge);
+            level = std::min(level + 1, topLevel);
+        }
+
+        return false;
+    }
+
+    void OceanHeightPyramid::Raycast(
+        const glm::vec3* origins,
+        const glm::vec3* directions,
+        uint32_t count,
+        float maxDistance,
+        OceanRayHit* hits,
+        uint8_t* hitMask)
+    {
+        m_ThreadPool.ParallelFor(count, BatchSize, [&](uint32_t begin, uint32_t end, uint32_t)
+        {
+            for (uint32_t i = begin; i < end; i++)
+            {
+                hitMask[i] = Raycast(origins[i], directions[i], maxDistance, hits[i]) ? 1 : 0;
+            }
+        });
+    }
+}
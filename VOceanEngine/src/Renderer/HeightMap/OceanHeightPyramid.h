@@ -0,0 +1,76 @@
+#pragma once
+
+#include "VOceanEngine/ThreadPool.h"
+
+namespace voe
+{
+    class OceanHeightQuery;
+
+    struct OceanRayHit
+    {
+        // distance along the normalized direction
+        float Distance = 0.0f;
+        glm::vec3 Position{};
+    };
+
+    // Min/max mip pyramid over the displaced ocean surface for ray casts.
+    // Build resamples the surface of an OceanHeightQuery on a regular grid of meshSize cells per tile
+    // (the displaced field isn't one), level 0 then holds the min/max of the four corners of every cell
+    // and each level above the min/max of 2x2 cells of the one below. The top level is one cell per tile.
+    // Raycast descends into a cell only if the ray segment across it reaches its height range,
+    // otherwise it skips the whole cell and goes back up a level. In a level 0 cell the ray is
+    // intersected exactly with the bilinear patch of the resampled heights.
+    // Same space as OceanHeightQuery and OceanBuoyancy: y points down, the water is where y >= height.
+    class VOE_API OceanHeightPyramid
+    {
+    public:
+        // rays per ParallelFor chunk
+        static constexpr uint32_t BatchSize = 64;
+
+        // threadCount is passed to the ThreadPool of the batched Raycast.
+        explicit OceanHeightPyramid(uint32_t threadCount = 0);
+        ~OceanHeightPyramid() = default;
+
+        OceanHeightPyramid(const OceanHeightPyramid&) = delete;
+        OceanHeightPyramid& operator=(const OceanHeightPyramid&) = delete;
+
+        // Call after every OceanHeightQuery::Update. The resampling runs on the pool of the query.
+        void Build(OceanHeightQuery& query);
+        bool IsEmpty() const { return m_Levels.empty(); }
+
+        uint32_t GetLevelCount() const { return static_cast<uint32_t>(m_Levels.size()); }
+        // min / max height of a cell, (x, z) in cells of that level
+        glm::vec2 GetBounds(uint32_t level, uint32_t x, uint32_t z) const;
+
+        // Returns false if the ray doesn't reach the water within maxDistance.
+        // A ray that starts under water hits at distance 0.
+        bool Raycast(glm::vec3 origin, glm::vec3 direction, float maxDistance, OceanRayHit& hit) const;
+
+        // origins, directions, hits and hitMask hold count elements, hitMask[i] is 1 for a hit.
+        void Raycast(
+            const glm::vec3* origins,
+            const glm::vec3* directions,
+            uint32_t count,
+            float maxDistance,
+            OceanRayHit* hits,
+            uint8_t* hitMask);
+
+    private:
+        float GetHeight(int32_t x, int32_t z) const;
+        // first t in [0, length] where the ray enters the water above level 0 cell (x, z)
+        bool IntersectCell(int32_t x, int32_t z, glm::vec3 origin, glm::vec3 direction, float t0, float t1, float& t) const;
+
+        uint32_t m_MeshSize = 0;
+        uint32_t m_MeshMask = 0;
+        float m_CellSize = 1.0f;
+
+        // resampled surface heights, element x * meshSize + z
+        std::vector<float> m_Heights;
+        // (min, max) per cell, level l has (meshSize >> l)^2 cells
+        std::vector<std::vector<glm::vec2>> m_Levels;
+
+        std::vector<glm::vec2> m_SamplePositions;
+
+        ThreadPool m_ThreadPool;
+    };
+}
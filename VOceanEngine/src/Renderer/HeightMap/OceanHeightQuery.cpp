@@ -0,0 +1,203 @@
+#include "PreCompileHeader.h"
+#include "OceanHeightQuery.h"
+
+namespace voe
+{
+    namespace
+    {
+        // Bilinear weights and the four element indices around a position in grid cells.
+        template<typename F>
+        struct BilinearTaps
+        {
+            typename F::Int I00, I01, I10, I11;
+            F Tx, Tz;
+
+            BilinearTaps(F gx, F gz, int32_t meshShift, int32_t meshMask)
+            {
+                using Int = typename F::Int;
+
+                F fx = simd::Floor(gx);
+                F fz = simd::Floor(gz);
+                Tx = gx - fx;
+                Tz = gz - fz;
+
+                // the field repeats, two's complement & mask wraps negative cells as well
+                Int mask = simd::SetInt<F>(meshMask);
+                Int x0 = simd::TruncateToInt(fx) & mask;
+                Int z0 = simd::TruncateToInt(fz) & mask;
+                Int x1 = (x0 + simd::SetInt<F>(1)) & mask;
+                Int z1 = (z0 + simd::SetInt<F>(1)) & mask;
+
+                // element i + j * meshSize is at x = j, z = i
+                Int row0 = simd::ShiftLeft(x0, meshShift);
+                Int row1 = simd::ShiftLeft(x1, meshShift);
+                I00 = row0 + z0;
+                I01 = row0 + z1;
+                I10 = row1 + z0;
+                I11 = row1 + z1;
+            }
+
+            F Sample(const float* channel) const
+            {
+                F v00 = simd::Gather(channel, I00);
+                F v01 = simd::Gather(channel, I01);
+                F v10 = simd::Gather(channel, I10);
+                F v11 = simd::Gather(channel, I11);
+
+                F v0 = v00 + (v01 - v00) * Tz;
+                F v1 = v10 + (v11 - v10) * Tz;
+                return v0 + (v1 - v0) * Tx;
+            }
+        };
+    }
+
+    OceanHeightQuery::OceanHeightQuery(uint32_t threadCount)
+        : m_ThreadPool(threadCount)
+    {
+    }
+
+    void OceanHeightQuery::Update(const glm::vec2* ht, uint32_t meshSize, float oceanSize, float lambda)
+    {
+        if (meshSize == 0 || (meshSize & (meshSize - 1)) != 0)
+        {
+            throw std::runtime_error("OceanHeightQuery: mesh size must be a power of two");
+        }
+
+        uint32_t elementCount = meshSize * meshSize;
+        if (m_MeshSize != meshSize)
+        {
+            m_MeshSize = meshSize;
+            m_MeshShift = 0;
+            while ((1u << m_MeshShift) < meshSize)
+                m_MeshShift++;
+
+            m_Height.resize(elementCount);
+            m_DisplacementX.resize(elementCount);
+            m_DisplacementZ.resize(elementCount);
+        }
+
+        m_OceanSize = oceanSize;
+        float cellSize = oceanSize / meshSize;
+        m_InvCellSize = 1.0f / cellSize;
+        float displacementScale = lambda / cellSize;
+
+        // plane 0 = (H_y, 0), plane 1 = (Dx, Dz)
+        const glm::vec2* heights = ht;
+        const glm::vec2* displacements = ht + elementCount;
+        for (uint32_t i = 0; i < elementCount; i++)
+        {
+            m_Height[i] = heights[i].x;
+            m_DisplacementX[i] = displacements[i].x * displacementScale;
+            m_DisplacementZ[i] = displacements[i].y * displacementScale;
+        }
+
+        m_Version++;
+    }
+
+    float OceanHeightQuery::Sample(const std::vector<float>& channel, glm::vec2 grid) const
+    {
+        uint32_t mask = m_MeshSize - 1;
+
+        glm::vec2 cell = glm::floor(grid);
+        glm::vec2 t = grid - cell;
+        uint32_t x0 = static_cast<uint32_t>(static_cast<int32_t>(cell.x)) & mask;
+        uint32_t z0 = static_cast<uint32_t>(static_cast<int32_t>(cell.y)) & mask;
+        uint32_t x1 = (x0 + 1) & mask;
+        uint32_t z1 = (z0 + 1) & mask;
+
+        float v0 = glm::mix(channel[(x0 << m_MeshShift) + z0], channel[(x0 << m_MeshShift) + z1], t.y);
+        float v1 = glm::mix(channel[(x1 << m_MeshShift) + z0], channel[(x1 << m_MeshShift) + z1], t.y);
+        return glm::mix(v0, v1, t.x);
+    }
+
+    glm::vec2 OceanHeightQuery::FindSource(glm::vec2 position) const
+    {
+        glm::vec2 target = position * m_InvCellSize;
+        glm::vec2 source = target;
+
+        for (uint32_t i = 0; i < m_Iterations; i++)
+        {
+            source = target - glm::vec2(Sample(m_DisplacementX, source), Sample(m_DisplacementZ, source));
+        }
+        return source;
+    }
+
+    float OceanHeightQuery::QueryHeight(glm::vec2 position) const
+    {
+        if (IsEmpty())
+            return 0.0f;
+
+        return Sample(m_Height, FindSource(position));
+    }
+
+    template<typename F>
+    void OceanHeightQuery::QueryBatch(const float* positions, float* heights, uint32_t count) const
+    {
+        const F invCellSize = F::Set1(m_InvCellSize);
+        const int32_t meshMask = static_cast<int32_t>(m_MeshSize - 1);
+
+        for (uint32_t i = 0; i < count; i += F::Width)
+        {
+            F tx, tz;
+            simd::LoadDeinterleaved(positions + 2 * i, tx, tz);
+            tx = tx * invCellSize;
+            tz = tz * invCellSize;
+
+            F sx = tx;
+            F sz = tz;
+            for (uint32_t iteration = 0; iteration < m_Iterations; iteration++)
+            {
+                BilinearTaps<F> taps(sx, sz, m_MeshShift, meshMask);
+                sx = tx - taps.Sample(m_DisplacementX.data());
+                sz = tz - taps.Sample(m_DisplacementZ.data());
+            }
+
+            BilinearTaps<F> taps(sx, sz, m_MeshShift, meshMask);
+            taps.Sample(m_Height.data()).Store(heights + i);
+        }
+    }
+
+    void OceanHeightQuery::QueryHeightsSerial(
+        const glm::vec2* positions,
+        float* heights,
+        uint32_t count,
+        simd::SimdLevel level) const
+    {
+        if (IsEmpty())
+        {
+            std::fill(heights, heights + count, 0.0f);
+            return;
+        }
+
+        uint32_t width = level == simd::SimdLevel::AVX2 ? 8 : 4;
+        uint32_t bulk = level == simd::SimdLevel::Scalar ? 0 : count - count % width;
+
+        switch (level)
+        {
+        case simd::SimdLevel::AVX2:
+            QueryBatch<simd::Float8>(&positions[0].x, heights, bulk);
+            _mm256_zeroupper();
+            break;
+        case simd::SimdLevel::SSE:
+            QueryBatch<simd::Float4>(&positions[0].x, heights, bulk);
+            break;
+        default:
+            break;
+        }
+
+        for (uint32_t i = bulk; i < count; i++)
+        {
+            heights[i] = QueryHeight(positions[i]);
+        }
+    }
+
+    void OceanHeightQuery::QueryHeights(const glm::vec2* positions, float* heights, uint32_t count)
+    {
+        simd::SimdLevel level = simd::GetSimdLevel();
+
+        m_ThreadPool.ParallelFor(count, BatchSize, [&](uint32_t begin, uint32_t end, uint32_t)
+        {
+            QueryHeightsSerial(positions + begin, heights + begin, end - begin, level);
+        });
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "VOceanEngine/SimdMath.h"
+#include "VOceanEngine/ThreadPool.h"
+
+namespace voe
+{
+    // Water height at horizontal positions, against one CPU displacement field (an OceanSnapshot
+    // or the state of an OceanSimulatorCPU).
+    // The rendered surface point of grid point p is p + lambda * (Dx, Dz)(p) at height H_y(p), so the
+    // height at q is H_y(p) for the p that lands on q. p is found with the fixed point iteration
+    // p = q - lambda * D(p), which converges wherever the surface doesn't fold over. Where it does
+    // (Jacobian < 0, see OceanSimulatorCPU::GetBubbleMap) several points land on q and the result
+    // is only approximate.
+    // Positions are in the model space of the ocean plane (Model::CreateXZPlaneModelFromProcedural):
+    // like testVert, element i + j * meshSize sits at x = j * dx, z = i * dz, and the field repeats
+    // every oceanSize in both directions.
+    // Every channel is sampled bilinearly with SIMD gathers (8 lanes with AVX2, 4 with SSE).
+    class VOE_API OceanHeightQuery
+    {
+    public:
+        static constexpr uint32_t DefaultIterations = 4;
+        // positions per ParallelFor chunk
+        static constexpr uint32_t BatchSize = 512;
+
+        // threadCount is passed to the ThreadPool of QueryHeights.
+        explicit OceanHeightQuery(uint32_t threadCount = 0);
+        ~OceanHeightQuery() = default;
+
+        OceanHeightQuery(const OceanHeightQuery&) = delete;
+        OceanHeightQuery& operator=(const OceanHeightQuery&) = delete;
+
+        // Copies H_y and the displacement out of ht (HtBuffers layout, see HeightMap::m_OceanPlaneCount).
+        // lambda is ComputeUBO::lamda. Queries see the new field from the next call on.
+        void Update(const glm::vec2* ht, uint32_t meshSize, float oceanSize, float lambda);
+
+        void SetIterations(uint32_t iterations) { m_Iterations = iterations; }
+        uint32_t GetIterations() const { return m_Iterations; }
+        bool IsEmpty() const { return m_MeshSize == 0; }
+        uint32_t GetMeshSize() const { return m_MeshSize; }
+        float GetOceanSize() const { return m_OceanSize; }
+        uint64_t GetVersion() const { return m_Version; }
+
+        // positions and heights hold count elements. Runs on the pool and returns when all are done.
+        // Not reentrant, one caller at a time.
+        void QueryHeights(const glm::vec2* positions, float* heights, uint32_t count);
+
+        // Same on the calling thread only, for callers that already run on a worker.
+        void QueryHeightsSerial(
+            const glm::vec2* positions,
+            float* heights,
+            uint32_t count,
+            simd::SimdLevel level = simd::GetSimdLevel()) const;
+
+        // Reference implementation, also used for the Scalar level.
+        float QueryHeight(glm::vec2 position) const;
+        // Where the surface point above position comes from, in grid cells.
+        glm::vec2 FindSource(glm::vec2 position) const;
+
+    private:
+        template<typename F>
+        void QueryBatch(const float* positions, float* heights, uint32_t count) const;
+
+        float Sample(const std::vector<float>& channel, glm::vec2 grid) const;
+
+        uint32_t m_MeshSize = 0;
+        int32_t m_MeshShift = 0;
+        float m_OceanSize = 0.0f;
+        // world units to grid cells
+        float m_InvCellSize = 1.0f;
+        uint32_t m_Iterations = DefaultIterations;
+        uint64_t m_Version = 0;
+
+        // meshSize * meshSize each, the displacement already scaled by lambda and in grid cells
+        std::vector<float> m_Height;
+        std::vector<float> m_DisplacementX;
+        std::vector<float> m_DisplacementZ;
+
+        ThreadPool m_ThreadPool;
+    };
+}
@@ -0,0 +1,173 @@
+#include "PreCompileHeader.h"
+#include "OceanLoop.h"
+
+#include "VOceanEngine/MappedFile.h"
+#include "Renderer/HeightMap/OceanSimulatorCPU.h"
+
+#include <glm/gtc/packing.hpp>
+
+#include <filesystem>
+
+namespace voe
+{
+    OceanLoop::OceanLoop(uint32_t meshSize, uint32_t frameCount, float period)
+        : m_MeshSize(meshSize), m_FrameCount(frameCount), m_Period(period)
+    {
+        if (frameCount == 0 || period <= 0.0f)
+        {
+            throw std::runtime_error("OceanLoop: frame count and period must be positive");
+        }
+
+        m_FrameElementCount = static_cast<size_t>(meshSize) * meshSize * ChannelCount;
+        m_Frames.resize(m_FrameElementCount * frameCount);
+    }
+
+    std::shared_ptr<OceanLoop> OceanLoop::Bake(
+        uint32_t meshSize,
+        const OceanSpectrumParams& params,
+        const DispersionParams& dispersion,
+        uint32_t frameCount,
+        uint32_t threadCount)
+    {
+        if (dispersion.LoopPeriod <= 0.0f)
+        {
+            throw std::runtime_error("OceanLoop: baking needs a dispersion with a loop period");
+        }
+
+        auto loop = std::make_shared<OceanLoop>(meshSize, frameCount, dispersion.LoopPeriod);
+
+        OceanSimulatorCPU simulator(meshSize, params, threadCount);
+        simulator.SetDispersion(dispersion);
+
+        uint32_t elementCount = meshSize * meshSize;
+        auto height = simulator.GetChannel(OceanSimulatorCPU::H_y);
+        auto dx = simulator.GetChannel(OceanSimulatorCPU::Dx);
+        auto dz = simulator.GetChannel(OceanSimulatorCPU::Dz);
+        const std::vector<glm::vec4>& normals = simulator.GetNormalMap();
+        const std::vector<float>& bubbles = simulator.GetBubbleMap();
+
+        for (uint32_t frame = 0; frame < frameCount; frame++)
+        {
+            // absolute times, so the last frame leads back into the first without drift
+            simulator.Simulate(frame * loop->GetFrameInterval());
+
+            uint16_t* data = loop->GetFrame(frame);
+            for (uint32_t i = 0; i < elementCount; i++)
+            {
+                data[H_y * elementCount + i] = glm::packHalf1x16(height[i]);
+                data[Dx * elementCount + i] = glm::packHalf1x16(dx[i]);
+                data[Dz * elementCount + i] = glm::packHalf1x16(dz[i]);
+                data[NormalX * elementCount + i] = glm::packHalf1x16(normals[i].x);
+                data[NormalZ * elementCount + i] = glm::packHalf1x16(normals[i].z);
+                data[Bubble * elementCount + i] = glm::packHalf1x16(bubbles[i]);
+            }
+        }
+
+        return loop;
+    }
+
+    void OceanLoop::ExpandFrame(uint32_t frame, void* slot) const
+    {
+        uint32_t elementCount = m_MeshSize * m_MeshSize;
+        const uint16_t* data = GetFrame(frame);
+
+        glm::vec2* planes = static_cast<glm::vec2*>(slot);
+        glm::vec4* normals = reinterpret_cast<glm::vec4*>(planes + 2 * elementCount);
+
+        for (uint32_t i = 0; i < elementCount; i++)
+        {
+            planes[i] = glm::vec2(glm::unpackHalf1x16(data[H_y * elementCount + i]), 0.0f);
+            planes[elementCount + i] = glm::vec2(
+                glm::unpackHalf1x16(data[Dx * elementCount + i]),
+                glm::unpackHalf1x16(data[Dz * elementCount + i]));
+
+            // oceanNormal.comp normalizes (-gradx, -1, -gradz), so y is always negative
+            float nx = glm::unpackHalf1x16(data[NormalX * elementCount + i]);
+            float nz = glm::unpackHalf1x16(data[NormalZ * elementCount + i]);
+            float ny = -std::sqrt(std::max(1.0f - nx * nx - nz * nz, 0.0f));
+            normals[i] = glm::vec4(nx, ny, nz, 1.0f);
+        }
+    }
+
+    void OceanLoop::ExpandBubble(uint32_t frame, float* bubble) const
+    {
+        uint32_t elementCount = m_MeshSize * m_MeshSize;
+        const uint16_t* data = GetFrame(frame) + Bubble * elementCount;
+
+        for (uint32_t i = 0; i < elementCount; i++)
+        {
+            bubble[i] = glm::unpackHalf1x16(data[i]);
+        }
+    }
+
+    std::shared_ptr<OceanLoop> OceanLoop::Load(const std::string& path)
+    {
+        MappedFile file;
+        if (!file.Open(path, MappedFile::Access::Read))
+        {
+            VOE_CORE_WARN("Failed to open ocean loop {0}", path);
+            return nullptr;
+        }
+
+        const Header* header = static_cast<const Header*>(file.GetData());
+        bool valid = file.GetSize() >= sizeof(Header)
+            && header->Magic == Magic
+            && header->Version == Version
+            && header->ChannelCount == ChannelCount
+            && header->MeshSize > 0
+            && header->FrameCount > 0
+            && header->Period > 0.0f
+            && file.GetSize() == sizeof(Header)
+                + static_cast<size_t>(header->MeshSize) * header->MeshSize * ChannelCount * header->FrameCount * sizeof(uint16_t);
+
+        if (!valid)
+        {
+            VOE_CORE_WARN("Ignoring invalid ocean loop {0}", path);
+            return nullptr;
+        }
+
+        auto loop = std::make_shared<OceanLoop>(header->MeshSize, header->FrameCount, header->Period);
+        std::memcpy(loop->m_Frames.data(), header + 1, loop->m_Frames.size() * sizeof(uint16_t));
+        return loop;
+    }
+
+    bool OceanLoop::Save(const std::string& path) const
+    {
+        // same as SpectrumCache::Store, a crash never leaves a truncated loop behind
+        std::string tempPath = path + ".tmp";
+        size_t dataSize = m_Frames.size() * sizeof(uint16_t);
+
+        {
+            MappedFile file;
+            if (!file.Open(tempPath, MappedFile::Access::Create, sizeof(Header) + dataSize))
+            {
+                VOE_CORE_WARN("Failed to create ocean loop {0}", tempPath);
+                return false;
+            }
+
+            Header header = { Magic, Version, m_MeshSize, m_FrameCount, m_Period, ChannelCount, { 0, 0 } };
+            std::memcpy(file.GetData(), &header, sizeof(Header));
+            std::memcpy(static_cast<uint8_t*>(file.GetData()) + sizeof(Header), m_Frames.data(), dataSize);
+
+            if (!file.Flush())
+            {
+                VOE_CORE_WARN("Failed to write ocean loop {0}", tempPath);
+                file.Close();
+                std::error_code ec;
+                std::filesystem::remove(tempPath, ec);
+                return false;
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(tempPath, path, ec);
+        if (ec)
+        {
+            VOE_CORE_WARN("Failed to replace ocean loop {0}", path);
+            std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+
+        return true;
+    }
+}
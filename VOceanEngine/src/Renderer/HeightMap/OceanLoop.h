@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Renderer/HeightMap/OceanDispersion.h"
+#include "Renderer/HeightMap/OceanSpectrum.h"
+
+namespace voe
+{
+    // One period of a looping ocean (DispersionParams::LoopPeriod > 0), baked into FrameCount
+    // evenly spaced frames. Played back through HeightMap::SetPlayback, which streams the frames
+    // into the history buffer instead of running the compute chain.
+    // A frame only keeps what the ocean shaders read - H_y, Dx, Dz and the normal for testVert and the
+    // Jacobian for the foam of testFrag - as half floats, meshSize * meshSize * 12 bytes per frame.
+    // The y component of the normal is rebuilt on expansion.
+    class VOE_API OceanLoop
+    {
+    public:
+        enum Channel : uint32_t
+        {
+            H_y = 0,
+            Dx,
+            Dz,
+            NormalX,
+            NormalZ,
+            // oceanNormal.comp's OceanBubbleImage
+            Bubble,
+            ChannelCount
+        };
+
+        // "VOLP"
+        static constexpr uint32_t Magic = 0x504C4F56;
+        static constexpr uint32_t Version = 2;
+
+        struct Header
+        {
+            uint32_t Magic;
+            uint32_t Version;
+            uint32_t MeshSize;
+            uint32_t FrameCount;
+            float Period;
+            uint32_t ChannelCount;
+            uint32_t Reserved[2];
+        };
+        static_assert(sizeof(Header) == 32, "frames have to start 32 bytes into the file");
+
+        // Runs OceanSimulatorCPU over one loop period. dispersion.LoopPeriod has to be positive,
+        // frame i is the ocean at i * LoopPeriod / frameCount.
+        // threadCount is passed to the ThreadPool of the simulator.
+        static std::shared_ptr<OceanLoop> Bake(
+            uint32_t meshSize,
+            const OceanSpectrumParams& params,
+            const DispersionParams& dispersion,
+            uint32_t frameCount,
+            uint32_t threadCount = 0);
+
+        // Returns nullptr (and logs) if the file is missing or doesn't hold a loop of this version.
+        static std::shared_ptr<OceanLoop> Load(const std::string& path);
+        // Failures are logged and otherwise ignored.
+        bool Save(const std::string& path) const;
+
+        OceanLoop(uint32_t meshSize, uint32_t frameCount, float period);
+
+        uint32_t GetMeshSize() const { return m_MeshSize; }
+        uint32_t GetFrameCount() const { return m_FrameCount; }
+        // in units of ComputeUBO::deltaT
+        float GetPeriod() const { return m_Period; }
+        float GetFrameInterval() const { return m_Period / m_FrameCount; }
+        size_t GetFrameSize() const { return m_FrameElementCount * sizeof(uint16_t); }
+
+        // ChannelCount planes of meshSize * meshSize half floats
+        uint16_t* GetFrame(uint32_t frame) { return &m_Frames[frame * m_FrameElementCount]; }
+        const uint16_t* GetFrame(uint32_t frame) const { return &m_Frames[frame * m_FrameElementCount]; }
+
+        // Writes a frame in the layout of a HeightMap history slot:
+        // planes 0 and 1 of HtBuffers as vec2, then the normal map as vec4.
+        void ExpandFrame(uint32_t frame, void* slot) const;
+        // Writes the meshSize * meshSize Jacobian of a frame, the texels of OceanBubbleImage.
+        void ExpandBubble(uint32_t frame, float* bubble) const;
+
+    private:
+        uint32_t m_MeshSize;
+        uint32_t m_FrameCount;
+        float m_Period;
+        size_t m_FrameElementCount;
+
+        std::vector<uint16_t> m_Frames;
+    };
+}
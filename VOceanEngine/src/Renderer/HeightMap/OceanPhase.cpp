@@ -0,0 +1,24 @@
+#include "PreCompileHeader.h"
+#include "OceanPhase.h"
+
+namespace voe
+{
+    void InitializePhases(
+        const std::vector<WaveVector>& waves,
+        float time,
+        float dt,
+        std::vector<PhaseState>& phases)
+    {
+        phases.resize(waves.size());
+
+        for (size_t i = 0; i < waves.size(); i++)
+        {
+            double w = waves[i].Omega;
+
+            // in double, the step is applied thousands of times
+            PhaseState& phase = phases[i];
+            phase.Phasor = glm::vec2(std::cos(w * time), std::sin(w * time));
+            phase.Step = glm::vec2(std::cos(w * dt), std::sin(w * dt));
+        }
+    }
+}
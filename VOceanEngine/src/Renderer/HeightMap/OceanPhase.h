@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Renderer/HeightMap/OceanDispersion.h"
+
+namespace voe
+{
+    // Time stepping of h(k, t) = h0(k) e^(iwt) + conj(h0(-k)) e^(-iwt).
+    enum class TimeStepMode : uint32_t
+    {
+        // e^(iwt) evaluated from the absolute time (ComputeUBO::deltaT) every frame
+        Absolute = 0,
+        // Every bin keeps its current phasor and multiplies it by the constant e^(iw dt) of a
+        // fixed step, so a step needs no transcendental math. Rounding slowly moves |phasor|
+        // away from 1, so it is pulled back every PhaseRenormalizeInterval steps.
+        Incremental
+    };
+
+    // One element of PhaseBuffer (a vec4 in spectrum.glsl).
+    struct PhaseState
+    {
+        // e^(iwt) of the last step
+        glm::vec2 Phasor;
+        // e^(iw dt)
+        glm::vec2 Step;
+    };
+
+    static constexpr uint32_t PhaseRenormalizeInterval = 64;
+
+    // Phasors at time and steps of dt for every bin, with the w of the wave table that
+    // spectrum.glsl uses (see BuildWaveTable). phases is resized to waves.size().
+    VOE_API void InitializePhases(
+        const std::vector<WaveVector>& waves,
+        float time,
+        float dt,
+        std::vector<PhaseState>& phases);
+
+    // One Newton step towards |phasor| = 1, plenty for the drift of a few dozen steps.
+    inline glm::vec2 RenormalizePhasor(glm::vec2 phasor)
+    {
+        return phasor * (1.5f - 0.5f * glm::dot(phasor, phasor));
+    }
+}
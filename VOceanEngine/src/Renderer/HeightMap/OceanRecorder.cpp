@@ -0,0 +1,458 @@
+#include "PreCompileHeader.h"
+#include "OceanRecorder.h"
+
+#ifndef VOE_PLATFORM_WINDOWS
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace voe
+{
+    namespace
+    {
+        constexpr float MaxCode = 65535.0f;
+
+        size_t AlignUp(size_t size)
+        {
+            return (size + OceanRecorder::Alignment - 1) & ~static_cast<size_t>(OceanRecorder::Alignment - 1);
+        }
+
+        // Encoder and decoder share these, so both predict the exact same codes.
+        int32_t Quantize(float value, float scale, float bias)
+        {
+            float code = std::round((value - bias) / scale);
+            return static_cast<int32_t>(std::min(std::max(code, 0.0f), MaxCode));
+        }
+
+        float Dequantize(int32_t code, float scale, float bias)
+        {
+            return bias + static_cast<float>(code) * scale;
+        }
+
+        uint8_t* WriteVarint(uint8_t* out, int32_t value)
+        {
+            // zigzag, small magnitudes of either sign become small numbers
+            uint32_t v = (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+            while (v >= 0x80)
+            {
+                *out++ = static_cast<uint8_t>(v | 0x80);
+                v >>= 7;
+            }
+            *out++ = static_cast<uint8_t>(v);
+            return out;
+        }
+
+        const uint8_t* ReadVarint(const uint8_t* in, int32_t& value)
+        {
+            uint32_t v = 0;
+            for (uint32_t shift = 0; ; shift += 7)
+            {
+                uint8_t byte = *in++;
+                v |= static_cast<uint32_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0)
+                    break;
+            }
+            value = static_cast<int32_t>(v >> 1) ^ -static_cast<int32_t>(v & 1);
+            return in;
+        }
+
+        // a residual of 17 bits takes 3 bytes
+        constexpr size_t MaxVarintSize = 3;
+    }
+
+    OceanRecorder::~OceanRecorder()
+    {
+        Stop();
+    }
+
+    bool OceanRecorder::Start(
+        const std::string& path,
+        uint32_t meshSize,
+        float oceanSize,
+        float lambda,
+        size_t chunkSize)
+    {
+        Stop();
+
+        if (meshSize == 0 || chunkSize == 0)
+        {
+            throw std::runtime_error("OceanRecorder: mesh and chunk size must be positive");
+        }
+
+        m_ElementCount = meshSize * meshSize;
+        m_ChunkSize = chunkSize;
+        m_RecordedFrames = 0;
+        m_DroppedFrames = 0;
+        m_BytesWritten = 0;
+
+        if (!OpenFile(path))
+        {
+            VOE_CORE_WARN("Failed to create ocean recording {0}", path);
+            return false;
+        }
+
+        // a chunk is flushed once it reaches m_ChunkSize, so it holds one more frame at most
+        size_t maxFrameSize = sizeof(FrameHeader) + static_cast<size_t>(m_ElementCount) * ChannelCount * MaxVarintSize;
+        m_ChunkStorage.assign(AlignUp(m_ChunkSize + maxFrameSize) + 2 * Alignment, 0);
+        m_Chunk = reinterpret_cast<uint8_t*>(AlignUp(reinterpret_cast<size_t>(m_ChunkStorage.data())));
+
+        FileHeader header = { Magic, Version, meshSize, ChannelCount, oceanSize, lambda, Alignment };
+        std::memset(m_Chunk, 0, Alignment);
+        std::memcpy(m_Chunk, &header, sizeof(FileHeader));
+        if (!WriteAligned(m_Chunk, Alignment))
+        {
+            VOE_CORE_WARN("Failed to write ocean recording {0}", path);
+            CloseFile();
+            return false;
+        }
+
+        m_ChunkFill = sizeof(ChunkHeader);
+        m_ChunkFrames = 0;
+        m_Previous.assign(static_cast<size_t>(m_ElementCount) * ChannelCount, 0.0f);
+        m_WriteFailed = false;
+
+        m_FreeFrames.clear();
+        m_Queue.clear();
+        for (uint32_t i = 0; i < QueueDepth; i++)
+        {
+            auto frame = std::make_unique<Frame>();
+            frame->Channels.resize(static_cast<size_t>(m_ElementCount) * ChannelCount);
+            m_FreeFrames.push_back(std::move(frame));
+        }
+
+        m_Stop = false;
+        m_Thread = std::thread(&OceanRecorder::Run, this);
+        return true;
+    }
+
+    void OceanRecorder::Stop()
+    {
+        if (!m_Thread.joinable())
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Stop = true;
+        }
+        m_Condition.notify_one();
+        m_Thread.join();
+    }
+
+    bool OceanRecorder::Submit(uint64_t frameId, float time, const glm::vec2* ht, const glm::vec4* normalMap)
+    {
+        if (!IsRecording())
+            return false;
+
+        std::unique_ptr<Frame> frame;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            if (!m_FreeFrames.empty())
+            {
+                frame = std::move(m_FreeFrames.back());
+                m_FreeFrames.pop_back();
+            }
+        }
+
+        // the recorder thread is behind
+        if (!frame)
+        {
+            m_DroppedFrames.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        frame->FrameId = frameId;
+        frame->Time = time;
+
+        // plane 0 = (H_y, 0), plane 1 = (Dx, Dz)
+        uint32_t n = m_ElementCount;
+        float* channels = frame->Channels.data();
+        for (uint32_t i = 0; i < n; i++)
+        {
+            channels[H_y * n + i] = ht[i].x;
+            channels[Dx * n + i] = ht[n + i].x;
+            channels[Dz * n + i] = ht[n + i].y;
+            channels[NormalX * n + i] = normalMap[i].x;
+            channels[NormalZ * n + i] = normalMap[i].z;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Queue.push_back(std::move(frame));
+        }
+        m_Condition.notify_one();
+        return true;
+    }
+
+    void OceanRecorder::Run()
+    {
+        while (true)
+        {
+            std::unique_ptr<Frame> frame;
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_Condition.wait(lock, [this]() { return m_Stop || !m_Queue.empty(); });
+
+                // drain the queue before stopping
+                if (m_Queue.empty())
+                    break;
+
+                frame = std::move(m_Queue.front());
+                m_Queue.pop_front();
+            }
+
+            if (!m_WriteFailed)
+            {
+                Encode(*frame);
+            }
+
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_FreeFrames.push_back(std::move(frame));
+        }
+
+        if (m_ChunkFrames > 0)
+        {
+            FlushChunk();
+        }
+        CloseFile();
+    }
+
+    void OceanRecorder::Encode(const Frame& frame)
+    {
+        bool keyFrame = m_ChunkFrames == 0;
+        uint32_t n = m_ElementCount;
+
+        FrameHeader header = {};
+        header.FrameId = frame.FrameId;
+        header.Time = frame.Time;
+        header.Flags = keyFrame ? KeyFrame : 0;
+
+        uint8_t* begin = m_Chunk + m_ChunkFill + sizeof(FrameHeader);
+        uint8_t* out = begin;
+
+        for (uint32_t channel = 0; channel < ChannelCount; channel++)
+        {
+            const float* values = &frame.Channels[channel * n];
+            float* previous = &m_Previous[channel * n];
+
+            auto range = std::minmax_element(values, values + n);
+            float bias = *range.first;
+            float scale = std::max(*range.second - bias, std::numeric_limits<float>::min()) / MaxCode;
+            header.Scale[channel] = scale;
+            header.Bias[channel] = bias;
+
+            for (uint32_t i = 0; i < n; i++)
+            {
+                int32_t prediction = keyFrame ? 0 : Quantize(previous[i], scale, bias);
+                int32_t code = Quantize(values[i], scale, bias);
+                out = WriteVarint(out, code - prediction);
+                previous[i] = Dequantize(code, scale, bias);
+            }
+        }
+
+        header.PayloadSize = static_cast<uint32_t>(out - begin);
+        std::memcpy(m_Chunk + m_ChunkFill, &header, sizeof(FrameHeader));
+        m_ChunkFill += sizeof(FrameHeader) + header.PayloadSize;
+        m_ChunkFrames++;
+        m_RecordedFrames.fetch_add(1, std::memory_order_relaxed);
+
+        if (m_ChunkFill >= m_ChunkSize)
+        {
+            FlushChunk();
+        }
+    }
+
+    void OceanRecorder::FlushChunk()
+    {
+        size_t chunkSize = AlignUp(m_ChunkFill);
+
+        ChunkHeader header = {};
+        header.Magic = ChunkMagic;
+        header.FrameCount = m_ChunkFrames;
+        header.PayloadSize = m_ChunkFill - sizeof(ChunkHeader);
+        header.ChunkSize = chunkSize;
+        std::memcpy(m_Chunk, &header, sizeof(ChunkHeader));
+        std::memset(m_Chunk + m_ChunkFill, 0, chunkSize - m_ChunkFill);
+
+        if (!WriteAligned(m_Chunk, chunkSize))
+        {
+            VOE_CORE_ERROR("Failed to write ocean recording, stopping at frame {0}", GetRecordedFrames());
+            m_WriteFailed = true;
+        }
+
+        // the next chunk starts with a key frame
+        m_ChunkFill = sizeof(ChunkHeader);
+        m_ChunkFrames = 0;
+    }
+
+#ifdef VOE_PLATFORM_WINDOWS
+    bool OceanRecorder::OpenFile(const std::string& path)
+    {
+        // whole aligned chunks go straight to the disk, they would only push other data out of the cache
+        m_File = CreateFileA(
+            path.c_str(),
+            GENERIC_WRITE,
+            FILE_SHARE_READ,
+            nullptr,
+            CREATE_ALWAYS,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_NO_BUFFERING | FILE_FLAG_SEQUENTIAL_SCAN,
+            nullptr);
+
+        return m_File != INVALID_HANDLE_VALUE;
+    }
+
+    bool OceanRecorder::WriteAligned(const uint8_t* data, size_t size)
+    {
+        while (size > 0)
+        {
+            DWORD written = 0;
+            DWORD request = static_cast<DWORD>(std::min<size_t>(size, 1u << 30));
+            if (!WriteFile(m_File, data, request, &written, nullptr) || written == 0)
+                return false;
+
+            data += written;
+            size -= written;
+            m_BytesWritten.fetch_add(written, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    void OceanRecorder::CloseFile()
+    {
+        if (m_File != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(m_File);
+            m_File = INVALID_HANDLE_VALUE;
+        }
+    }
+#else
+    bool OceanRecorder::OpenFile(const std::string& path)
+    {
+        m_File = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        return m_File >= 0;
+    }
+
+    bool OceanRecorder::WriteAligned(const uint8_t* data, size_t size)
+    {
+        while (size > 0)
+        {
+            ssize_t written = write(m_File, data, size);
+            if (written <= 0)
+                return false;
+
+            data += written;
+            size -= static_cast<size_t>(written);
+            m_BytesWritten.fetch_add(static_cast<uint64_t>(written), std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    void OceanRecorder::CloseFile()
+    {
+        if (m_File >= 0)
+        {
+            close(m_File);
+            m_File = -1;
+        }
+    }
+#endif
+
+    bool OceanRecordingReader::Open(const std::string& path)
+    {
+        Close();
+
+        if (!m_File.Open(path, MappedFile::Access::Read))
+        {
+            VOE_CORE_WARN("Failed to open ocean recording {0}", path);
+            return false;
+        }
+
+        bool valid = m_File.GetSize() >= OceanRecorder::Alignment;
+        if (valid)
+        {
+            std::memcpy(&m_Header, m_File.GetData(), sizeof(m_Header));
+            valid = m_Header.Magic == OceanRecorder::Magic
+                && m_Header.Version == OceanRecorder::Version
+                && m_Header.ChannelCount == OceanRecorder::ChannelCount
+                && m_Header.MeshSize > 0;
+        }
+
+        if (!valid)
+        {
+            VOE_CORE_WARN("Ignoring ocean recording {0} of another version", path);
+            Close();
+            return false;
+        }
+
+        m_ChunkOffset = m_Header.Alignment;
+        m_Previous.assign(static_cast<size_t>(m_Header.MeshSize) * m_Header.MeshSize * OceanRecorder::ChannelCount, 0.0f);
+        return true;
+    }
+
+    void OceanRecordingReader::Close()
+    {
+        m_File.Close();
+        m_Header = {};
+        m_ChunkOffset = 0;
+        m_FrameOffset = 0;
+        m_ChunkFramesLeft = 0;
+    }
+
+    bool OceanRecordingReader::ReadFrame(uint64_t& frameId, float& time, std::vector<float>& channels)
+    {
+        if (!m_File.IsOpen())
+            return false;
+
+        const uint8_t* data = static_cast<const uint8_t*>(m_File.GetData());
+        size_t fileSize = m_File.GetSize();
+
+        if (m_ChunkFramesLeft == 0)
+        {
+            if (m_ChunkOffset + sizeof(OceanRecorder::ChunkHeader) > fileSize)
+                return false;
+
+            OceanRecorder::ChunkHeader chunk;
+            std::memcpy(&chunk, data + m_ChunkOffset, sizeof(chunk));
+            if (chunk.Magic != OceanRecorder::ChunkMagic
+                || chunk.FrameCount == 0
+                || m_ChunkOffset + sizeof(chunk) + chunk.PayloadSize > fileSize)
+            {
+                // a recording cut off by a crash ends at its last complete chunk
+                return false;
+            }
+
+            m_FrameOffset = m_ChunkOffset + sizeof(chunk);
+            m_ChunkFramesLeft = chunk.FrameCount;
+            m_ChunkOffset += chunk.ChunkSize;
+        }
+
+        OceanRecorder::FrameHeader header;
+        std::memcpy(&header, data + m_FrameOffset, sizeof(header));
+
+        uint32_t n = m_Header.MeshSize * m_Header.MeshSize;
+        bool keyFrame = (header.Flags & OceanRecorder::KeyFrame) != 0;
+        channels.resize(m_Previous.size());
+
+        const uint8_t* in = data + m_FrameOffset + sizeof(header);
+        for (uint32_t channel = 0; channel < OceanRecorder::ChannelCount; channel++)
+        {
+            float scale = header.Scale[channel];
+            float bias = header.Bias[channel];
+            float* previous = &m_Previous[channel * n];
+
+            for (uint32_t i = 0; i < n; i++)
+            {
+                int32_t residual;
+                in = ReadVarint(in, residual);
+                int32_t prediction = keyFrame ? 0 : Quantize(previous[i], scale, bias);
+                previous[i] = Dequantize(prediction + residual, scale, bias);
+            }
+        }
+        std::copy(m_Previous.begin(), m_Previous.end(), channels.begin());
+
+        frameId = header.FrameId;
+        time = header.Time;
+        m_FrameOffset += sizeof(header) + header.PayloadSize;
+        m_ChunkFramesLeft--;
+        return true;
+    }
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+#include "VOceanEngine/MappedFile.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace voe
+{
+    // Records a sequence of CPU ocean frames (OceanSnapshot, OceanSimulatorCPU or OceanSharedFrame)
+    // to disk for offline analysis. Submit only copies the frame into a free buffer of a small pool;
+    // quantization, encoding and writing happen on the recorder's own thread. If the disk can't keep
+    // up and the pool runs dry, Submit drops the frame instead of waiting.
+    //
+    // A frame keeps the vertex channels of OceanLoop - H_y, Dx, Dz and the x and z of the normal - quantized to
+    // 16 bits with a scale and bias per channel and frame. Each code is stored as the zigzag varint
+    // of its difference to the previous frame's value requantized with the current scale and bias,
+    // so slowly changing channels mostly take one or two bytes per element.
+    // Frames are grouped into chunks that start with a key frame (predicted from 0) and are written
+    // with one write each, aligned and padded to Alignment so the file can bypass the OS cache.
+    class VOE_API OceanRecorder
+    {
+    public:
+        enum Channel : uint32_t
+        {
+            H_y = 0,
+            Dx,
+            Dz,
+            NormalX,
+            NormalZ,
+            ChannelCount
+        };
+
+        // "VORC"
+        static constexpr uint32_t Magic = 0x43524F56;
+        // "VOCK"
+        static constexpr uint32_t ChunkMagic = 0x4B434F56;
+        static constexpr uint32_t Version = 1;
+        // file offsets and sizes of every write, a multiple of the sector size
+        static constexpr uint32_t Alignment = 4096;
+        static constexpr size_t DefaultChunkSize = 8u << 20;
+        // frames that can wait for the recorder thread
+        static constexpr uint32_t QueueDepth = 8;
+
+        // First block of the file, padded to Alignment.
+        struct FileHeader
+        {
+            uint32_t Magic;
+            uint32_t Version;
+            uint32_t MeshSize;
+            uint32_t ChannelCount;
+            float OceanSize;
+            float Lambda;
+            uint32_t Alignment;
+            uint32_t Reserved[9];
+        };
+        static_assert(sizeof(FileHeader) == 64, "unexpected padding");
+
+        struct ChunkHeader
+        {
+            uint32_t Magic;
+            uint32_t FrameCount;
+            // bytes of frames after this header
+            uint64_t PayloadSize;
+            // distance to the next chunk, a multiple of Alignment
+            uint64_t ChunkSize;
+            uint64_t Reserved[5];
+        };
+        static_assert(sizeof(ChunkHeader) == 64, "unexpected padding");
+
+        struct FrameHeader
+        {
+            uint64_t FrameId;
+            float Time;
+            // KeyFrame
+            uint32_t Flags;
+            // bytes of varints after this header
+            uint32_t PayloadSize;
+            uint32_t Reserved;
+            // value = Bias + code * Scale
+            float Scale[ChannelCount];
+            float Bias[ChannelCount];
+        };
+        static_assert(sizeof(FrameHeader) == 64, "unexpected padding");
+
+        static constexpr uint32_t KeyFrame = 1;
+
+        OceanRecorder() = default;
+        ~OceanRecorder();
+
+        OceanRecorder(const OceanRecorder&) = delete;
+        OceanRecorder& operator=(const OceanRecorder&) = delete;
+
+        // Creates the file and starts the recorder thread. Returns false (and logs) if the file can't be created.
+        // oceanSize and lambda only go into the header, for readers that want world units.
+        bool Start(
+            const std::string& path,
+            uint32_t meshSize,
+            float oceanSize,
+            float lambda,
+            size_t chunkSize = DefaultChunkSize);
+        // Writes everything submitted so far and closes the file.
+        void Stop();
+        bool IsRecording() const { return m_Thread.joinable(); }
+
+        // ht (two HtBuffers planes) and normalMap as in OceanSimulatorCPU. Never waits for the disk,
+        // returns false if the frame was dropped.
+        bool Submit(uint64_t frameId, float time, const glm::vec2* ht, const glm::vec4* normalMap);
+
+        uint64_t GetRecordedFrames() const { return m_RecordedFrames.load(std::memory_order_relaxed); }
+        uint64_t GetDroppedFrames() const { return m_DroppedFrames.load(std::memory_order_relaxed); }
+        uint64_t GetBytesWritten() const { return m_BytesWritten.load(std::memory_order_relaxed); }
+
+    private:
+        struct Frame
+        {
+            uint64_t FrameId = 0;
+            float Time = 0.0f;
+            // ChannelCount planes of meshSize * meshSize
+            std::vector<float> Channels;
+        };
+
+        void Run();
+        void Encode(const Frame& frame);
+        void FlushChunk();
+        bool OpenFile(const std::string& path);
+        bool WriteAligned(const uint8_t* data, size_t size);
+        void CloseFile();
+
+        uint32_t m_ElementCount = 0;
+        size_t m_ChunkSize = DefaultChunkSize;
+
+        // recorder thread
+        std::vector<uint8_t> m_ChunkStorage;
+        // m_ChunkStorage aligned to Alignment
+        uint8_t* m_Chunk = nullptr;
+        size_t m_ChunkFill = 0;
+        uint32_t m_ChunkFrames = 0;
+        // previous frame as the decoder sees it
+        std::vector<float> m_Previous;
+        bool m_WriteFailed = false;
+
+        std::mutex m_Mutex;
+        std::condition_variable m_Condition;
+        std::vector<std::unique_ptr<Frame>> m_FreeFrames;
+        std::deque<std::unique_ptr<Frame>> m_Queue;
+        bool m_Stop = false;
+        std::thread m_Thread;
+
+        std::atomic<uint64_t> m_RecordedFrames{ 0 };
+        std::atomic<uint64_t> m_DroppedFrames{ 0 };
+        std::atomic<uint64_t> m_BytesWritten{ 0 };
+
+#ifdef VOE_PLATFORM_WINDOWS
+        HANDLE m_File = INVALID_HANDLE_VALUE;
+#else
+        int m_File = -1;
+#endif
+    };
+
+    // Plays back a file of OceanRecorder frame by frame.
+    class VOE_API OceanRecordingReader
+    {
+    public:
+        // Returns false (and logs) if the file is missing or not a recording of this version.
+        bool Open(const std::string& path);
+        void Close();
+
+        uint32_t GetMeshSize() const { return m_Header.MeshSize; }
+        float GetOceanSize() const { return m_Header.OceanSize; }
+        float GetLambda() const { return m_Header.Lambda; }
+
+        // Decodes the next frame into channels (OceanRecorder::ChannelCount planes of meshSize * meshSize).
+        // Returns false at the end of the recording.
+        bool ReadFrame(uint64_t& frameId, float& time, std::vector<float>& channels);
+
+    private:
+        MappedFile m_File;
+        OceanRecorder::FileHeader m_Header{};
+        uint64_t m_ChunkOffset = 0;
+        uint64_t m_FrameOffset = 0;
+        uint32_t m_ChunkFramesLeft = 0;
+        std::vector<float> m_Previous;
+    };
+}
@@ -0,0 +1,186 @@
+#include "PreCompileHeader.h"
+#include "OceanSharedRing.h"
+
+namespace voe
+{
+    namespace OceanSharedRing
+    {
+        namespace
+        {
+            size_t GetFrameSize(uint32_t meshSize)
+            {
+                size_t elementCount = static_cast<size_t>(meshSize) * meshSize;
+                return 2 * elementCount * sizeof(glm::vec2) + elementCount * sizeof(glm::vec4);
+            }
+
+            size_t GetSlotStride(uint32_t meshSize)
+            {
+                // keep every slot on its own cache lines
+                return (sizeof(SlotHeader) + GetFrameSize(meshSize) + 63) & ~static_cast<size_t>(63);
+            }
+        }
+
+        size_t GetRingSize(uint32_t meshSize, uint32_t slotCount)
+        {
+            return sizeof(Header) + slotCount * GetSlotStride(meshSize);
+        }
+    }
+
+    bool OceanSharedPublisher::Open(
+        const std::string& name,
+        uint32_t meshSize,
+        float oceanSize,
+        float lambda,
+        uint32_t slotCount)
+    {
+        Close();
+
+        if (meshSize == 0 || slotCount < 2)
+        {
+            throw std::runtime_error("OceanSharedPublisher: needs a mesh and at least two slots");
+        }
+
+        if (!m_File.OpenShared(name, MappedFile::Access::Create, OceanSharedRing::GetRingSize(meshSize, slotCount)))
+        {
+            VOE_CORE_WARN("Failed to create shared ocean ring {0}", name);
+            return false;
+        }
+
+        // the new object is zero filled, so Magic is 0 until the header is complete
+        auto* header = static_cast<OceanSharedRing::Header*>(m_File.GetData());
+        header->Version = OceanSharedRing::Version;
+        header->MeshSize = meshSize;
+        header->SlotCount = slotCount;
+        header->OceanSize = oceanSize;
+        header->Lambda = lambda;
+        header->SlotOffset = sizeof(OceanSharedRing::Header);
+        header->SlotStride = OceanSharedRing::GetSlotStride(meshSize);
+        header->LatestFrame.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        header->Magic = OceanSharedRing::Magic;
+
+        m_Header = header;
+        m_ElementCount = meshSize * meshSize;
+        m_NextFrame = 1;
+        return true;
+    }
+
+    void OceanSharedPublisher::Close()
+    {
+        m_File.Close();
+        m_Header = nullptr;
+    }
+
+    uint64_t OceanSharedPublisher::Publish(float time, const glm::vec2* ht, const glm::vec4* normalMap)
+    {
+        if (m_Header == nullptr)
+            return 0;
+
+        uint64_t frameId = m_NextFrame++;
+        uint32_t slotIndex = static_cast<uint32_t>(frameId % m_Header->SlotCount);
+        uint8_t* slotData = static_cast<uint8_t*>(m_File.GetData()) + m_Header->SlotOffset + slotIndex * m_Header->SlotStride;
+        auto* slot = reinterpret_cast<OceanSharedRing::SlotHeader*>(slotData);
+
+        // odd: readers that acquired this slot fail Validate from here on
+        uint64_t sequence = slot->Sequence.load(std::memory_order_relaxed);
+        slot->Sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot->FrameId = frameId;
+        slot->Time = time;
+        uint8_t* frame = slotData + sizeof(OceanSharedRing::SlotHeader);
+        size_t htSize = 2 * static_cast<size_t>(m_ElementCount) * sizeof(glm::vec2);
+        std::memcpy(frame, ht, htSize);
+        std::memcpy(frame + htSize, normalMap, m_ElementCount * sizeof(glm::vec4));
+
+        slot->Sequence.store(sequence + 2, std::memory_order_release);
+        m_Header->LatestFrame.store(frameId, std::memory_order_release);
+        return frameId;
+    }
+
+    bool OceanSharedReader::Open(const std::string& name)
+    {
+        Close();
+
+        if (!m_File.OpenShared(name, MappedFile::Access::Read))
+        {
+            return false;
+        }
+
+        const auto* header = static_cast<const OceanSharedRing::Header*>(m_File.GetData());
+        bool valid = m_File.GetSize() >= sizeof(OceanSharedRing::Header) && header->Magic == OceanSharedRing::Magic;
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        valid = valid
+            && header->Version == OceanSharedRing::Version
+            && header->SlotCount >= 2
+            && m_File.GetSize() >= OceanSharedRing::GetRingSize(header->MeshSize, header->SlotCount);
+
+        if (!valid)
+        {
+            VOE_CORE_WARN("Ignoring shared ocean ring {0} of another version", name);
+            m_File.Close();
+            return false;
+        }
+
+        m_Header = header;
+        return true;
+    }
+
+    void OceanSharedReader::Close()
+    {
+        m_File.Close();
+        m_Header = nullptr;
+    }
+
+    const OceanSharedRing::SlotHeader* OceanSharedReader::GetSlot(uint32_t slot) const
+    {
+        const uint8_t* data = static_cast<const uint8_t*>(m_File.GetData()) + m_Header->SlotOffset + slot * m_Header->SlotStride;
+        return reinterpret_cast<const OceanSharedRing::SlotHeader*>(data);
+    }
+
+    bool OceanSharedReader::Acquire(OceanSharedFrame& frame) const
+    {
+        if (m_Header == nullptr)
+            return false;
+
+        size_t elementCount = static_cast<size_t>(m_Header->MeshSize) * m_Header->MeshSize;
+
+        for (uint32_t retry = 0; retry < MaxRetries; retry++)
+        {
+            uint64_t latest = m_Header->LatestFrame.load(std::memory_order_acquire);
+            if (latest == 0)
+                return false;
+
+            uint32_t slotIndex = static_cast<uint32_t>(latest % m_Header->SlotCount);
+            const OceanSharedRing::SlotHeader* slot = GetSlot(slotIndex);
+
+            uint64_t sequence = slot->Sequence.load(std::memory_order_acquire);
+            if (sequence & 1)
+                continue;
+
+            frame.FrameId = slot->FrameId;
+            frame.Time = slot->Time;
+            frame.Slot = slotIndex;
+            frame.Sequence = sequence;
+
+            // the slot already holds a newer frame than latest, or is being rewritten
+            if (frame.FrameId != latest || !Validate(frame))
+                continue;
+
+            const uint8_t* data = reinterpret_cast<const uint8_t*>(slot + 1);
+            frame.Ht = reinterpret_cast<const glm::vec2*>(data);
+            frame.NormalMap = reinterpret_cast<const glm::vec4*>(data + 2 * elementCount * sizeof(glm::vec2));
+            return true;
+        }
+
+        return false;
+    }
+
+    bool OceanSharedReader::Validate(const OceanSharedFrame& frame) const
+    {
+        // order every read of the frame before the second look at the sequence
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return GetSlot(frame.Slot)->Sequence.load(std::memory_order_relaxed) == frame.Sequence;
+    }
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "VOceanEngine/MappedFile.h"
+
+#include <atomic>
+
+namespace voe
+{
+    // Ring of ocean frames in named shared memory, for processes that need the current sea surface
+    // (physics servers, analytics, recorders). One OceanSharedPublisher writes, any number of
+    // OceanSharedReaders map the ring read-only and use the frames in place.
+    // Every slot is guarded by a seqlock: the writer makes the sequence odd, writes the frame and makes
+    // it even again. A reader remembers the sequence when it acquires a frame and checks it with
+    // Validate once it is done reading; if the writer came around to the slot in between, the data may
+    // be torn and has to be dropped. With SlotCount slots a reader has SlotCount - 1 frame intervals.
+    // A frame holds the two HtBuffers planes ((H_y, 0) then (Dx, Dz)) and the normal map of
+    // OceanSimulatorCPU, so it can be handed to OceanHeightQuery::Update as is.
+    namespace OceanSharedRing
+    {
+        // "VOSR"
+        constexpr uint32_t Magic = 0x52534F56;
+        constexpr uint32_t Version = 1;
+        constexpr uint32_t DefaultSlotCount = 4;
+        constexpr const char* DefaultName = "VOceanEngine.Ocean";
+
+        struct Header
+        {
+            uint32_t Magic;
+            uint32_t Version;
+            uint32_t MeshSize;
+            uint32_t SlotCount;
+            // world size of a tile and ComputeUBO::lamda, as set at OceanSharedPublisher::Open
+            float OceanSize;
+            float Lambda;
+            // bytes from the start of the ring to the first slot and between slots
+            uint64_t SlotOffset;
+            uint64_t SlotStride;
+            // id of the newest complete frame, 0 before the first one
+            std::atomic<uint64_t> LatestFrame;
+            uint32_t Reserved[4];
+        };
+        static_assert(sizeof(Header) == 64, "slots have to start on a cache line");
+
+        struct SlotHeader
+        {
+            // odd while the slot is written
+            std::atomic<uint64_t> Sequence;
+            uint64_t FrameId;
+            // simulation time, in units of ComputeUBO::deltaT
+            float Time;
+            uint32_t Reserved[11];
+        };
+        static_assert(sizeof(SlotHeader) == 64, "frames have to start on a cache line");
+        static_assert(std::atomic<uint64_t>::is_always_lock_free, "the seqlock has to work across processes");
+
+        // whole ring for meshSize, header included
+        size_t GetRingSize(uint32_t meshSize, uint32_t slotCount);
+    }
+
+    // A frame in the mapped ring. Only valid while OceanSharedReader::Validate says so.
+    struct OceanSharedFrame
+    {
+        uint64_t FrameId = 0;
+        float Time = 0.0f;
+        // 2 * meshSize * meshSize, HtBuffers layout
+        const glm::vec2* Ht = nullptr;
+        // meshSize * meshSize
+        const glm::vec4* NormalMap = nullptr;
+
+        uint32_t Slot = 0;
+        uint64_t Sequence = 0;
+    };
+
+    class VOE_API OceanSharedPublisher
+    {
+    public:
+        OceanSharedPublisher() = default;
+        ~OceanSharedPublisher() = default;
+
+        OceanSharedPublisher(const OceanSharedPublisher&) = delete;
+        OceanSharedPublisher& operator=(const OceanSharedPublisher&) = delete;
+
+        // Creates the ring. Returns false (and logs) if the shared memory can't be created, on Windows
+        // also if another publisher owns the name. Elsewhere the name is taken over, like a stale
+        // object left behind by a crash.
+        bool Open(
+            const std::string& name,
+            uint32_t meshSize,
+            float oceanSize,
+            float lambda,
+            uint32_t slotCount = OceanSharedRing::DefaultSlotCount);
+        void Close();
+        bool IsOpen() const { return m_File.IsOpen(); }
+
+        // Copies one frame into the next slot, ht and normalMap as in OceanSimulatorCPU.
+        // One writer thread only. Returns the id of the frame.
+        uint64_t Publish(float time, const glm::vec2* ht, const glm::vec4* normalMap);
+
+    private:
+        MappedFile m_File;
+        OceanSharedRing::Header* m_Header = nullptr;
+        uint32_t m_ElementCount = 0;
+        uint64_t m_NextFrame = 1;
+    };
+
+    class VOE_API OceanSharedReader
+    {
+    public:
+        // how often Acquire retries while the writer keeps overtaking it
+        static constexpr uint32_t MaxRetries = 8;
+
+        OceanSharedReader() = default;
+        ~OceanSharedReader() = default;
+
+        OceanSharedReader(const OceanSharedReader&) = delete;
+        OceanSharedReader& operator=(const OceanSharedReader&) = delete;
+
+        // Returns false if there is no ring of this version under name.
+        bool Open(const std::string& name);
+        void Close();
+        bool IsOpen() const { return m_Header != nullptr; }
+
+        uint32_t GetMeshSize() const { return m_Header->MeshSize; }
+        float GetOceanSize() const { return m_Header->OceanSize; }
+        float GetLambda() const { return m_Header->Lambda; }
+        uint64_t GetLatestFrameId() const { return m_Header->LatestFrame.load(std::memory_order_acquire); }
+
+        // Points frame at the newest complete frame without copying or locking.
+        // Returns false before the first frame or if the writer kept overwriting the slot.
+        bool Acquire(OceanSharedFrame& frame) const;
+        // True if nothing was written to the slot of frame since Acquire, i.e. everything read from it
+        // in between is consistent.
+        bool Validate(const OceanSharedFrame& frame) const;
+
+    private:
+        const OceanSharedRing::SlotHeader* GetSlot(uint32_t slot) const;
+
+        MappedFile m_File;
+        const OceanSharedRing::Header* m_Header = nullptr;
+    };
+}
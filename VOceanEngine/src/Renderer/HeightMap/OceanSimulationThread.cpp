@@ -0,0 +1,235 @@
+#include "PreCompileHeader.h"
+#include "OceanSimulationThread.h"
+
+namespace voe
+{
+    OceanSimulationThread::OceanSimulationThread(
+        uint32_t meshSize,
+        const OceanSpectrumParams& params,
+        float stepRate,
+        float timeScale,
+        uint32_t threadCount)
+        : m_Simulator(meshSize, params, threadCount), m_StepRate(stepRate), m_TimeScale(timeScale)
+    {
+        if (stepRate <= 0.0f)
+        {
+            throw std::runtime_error("OceanSimulationThread: step rate must be positive");
+        }
+
+        // publishing only copies into these
+        uint32_t elementCount = meshSize * meshSize;
+        m_Snapshots.ForEach([elementCount](OceanSnapshot& snapshot)
+        {
+            snapshot.Ht.resize(elementCount * HeightMap::m_OceanPlaneCount);
+            snapshot.NormalMap.resize(elementCount);
+            snapshot.BubbleMap.resize(elementCount);
+        });
+    }
+
+    OceanSimulationThread::~OceanSimulationThread()
+    {
+        Stop();
+    }
+
+    void OceanSimulationThread::SetStepCallback(StepCallback callback)
+    {
+        if (IsRunning())
+        {
+            throw std::runtime_error("OceanSimulationThread: step callback changed while running");
+        }
+        m_StepCallback = std::move(callback);
+    }
+
+    void OceanSimulationThread::SetDispersion(const DispersionParams& params)
+    {
+        if (IsRunning())
+        {
+            throw std::runtime_error("OceanSimulationThread: dispersion changed while running");
+        }
+        m_Simulator.SetDispersion(params);
+    }
+
+    void OceanSimulationThread::EnableSurfaceQueries(float oceanSize, float lambda, uint32_t threadCount)
+    {
+        if (IsRunning())
+        {
+            throw std::runtime_error("OceanSimulationThread: surface queries enabled while running");
+        }
+
+        m_QueryOceanSize = oceanSize;
+        m_QueryLambda = lambda;
+        m_Snapshots.ForEach([threadCount](OceanSnapshot& snapshot)
+        {
+            snapshot.HeightQuery = std::make_unique<OceanHeightQuery>(threadCount);
+            snapshot.HeightPyramid = std::make_unique<OceanHeightPyramid>(threadCount);
+        });
+    }
+
+    void OceanSimulationThread::FollowSubmittedTimes()
+    {
+        if (IsRunning())
+        {
+            throw std::runtime_error("OceanSimulationThread: time source changed while running");
+        }
+        m_FollowSubmittedTimes = true;
+    }
+
+    void OceanSimulationThread::Start(float startTime)
+    {
+        if (IsRunning())
+            return;
+
+        m_StartTime = startTime;
+        m_Stop = false;
+        m_HasSubmittedTime = false;
+        m_Thread = std::thread(&OceanSimulationThread::Run, this);
+    }
+
+    void OceanSimulationThread::Stop()
+    {
+        if (!IsRunning())
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(m_StopMutex);
+            m_Stop = true;
+        }
+        m_StopCondition.notify_one();
+        m_Thread.join();
+    }
+
+    const OceanSnapshot* OceanSimulationThread::AcquireLatest()
+    {
+        if (m_Snapshots.Update())
+        {
+            m_HasSnapshot = true;
+        }
+        return m_HasSnapshot ? &m_Snapshots.GetReadBuffer() : nullptr;
+    }
+
+    void OceanSimulationThread::SubmitStepTime(float time)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_StopMutex);
+            m_SubmittedTime = time;
+            m_HasSubmittedTime = true;
+        }
+        m_StopCondition.notify_one();
+    }
+
+    void OceanSimulationThread::Run()
+    {
+        if (m_FollowSubmittedTimes)
+        {
+            RunOnSubmittedTimes();
+        }
+        else
+        {
+            RunOnWallClock();
+        }
+    }
+
+    void OceanSimulationThread::RunOnWallClock()
+    {
+        using Clock = std::chrono::steady_clock;
+
+        const auto stepDuration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / m_StepRate));
+        const float dt = m_TimeScale / m_StepRate;
+
+        const auto start = Clock::now();
+        // index of the next step on the wall clock, step n is at m_StartTime + n * dt
+        uint64_t tick = 1;
+
+        m_Simulator.BeginStepping(m_StartTime, dt);
+
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_StopMutex);
+                if (m_StopCondition.wait_until(lock, start + tick * stepDuration, [this]() { return m_Stop; }))
+                    break;
+            }
+
+            auto stepStart = Clock::now();
+
+            uint64_t dueTick = static_cast<uint64_t>((stepStart - start) / stepDuration);
+            if (dueTick > tick + MaxLagSteps)
+            {
+                // too far behind: skip to now, the next Step() lands on dueTick
+                tick = dueTick;
+                m_Simulator.BeginStepping(m_StartTime + (tick - 1) * dt, dt);
+            }
+
+            Step(stepStart);
+            tick++;
+        }
+    }
+
+    void OceanSimulationThread::RunOnSubmittedTimes()
+    {
+        using Clock = std::chrono::steady_clock;
+
+        const float dt = m_TimeScale / m_StepRate;
+        // the submitting side accumulates its time step by step, so a step of dt is only equal to within rounding
+        const float tolerance = dt * 0.01f;
+        bool stepping = false;
+
+        while (true)
+        {
+            float time;
+            {
+                std::unique_lock<std::mutex> lock(m_StopMutex);
+                m_StopCondition.wait(lock, [this]() { return m_Stop || m_HasSubmittedTime; });
+                if (m_Stop)
+                    break;
+
+                time = m_SubmittedTime;
+                m_HasSubmittedTime = false;
+            }
+
+            auto stepStart = Clock::now();
+
+            if (!stepping || std::abs(time - (m_Simulator.GetStepTime() + dt)) > tolerance)
+            {
+                // first step, dropped steps or a step of another length: the next Step() lands on time
+                m_Simulator.BeginStepping(time - dt, dt);
+                stepping = true;
+            }
+
+            Step(stepStart);
+        }
+    }
+
+    void OceanSimulationThread::Step(std::chrono::steady_clock::time_point stepStart)
+    {
+        m_Simulator.Step();
+        if (m_StepCallback)
+        {
+            m_StepCallback(m_Simulator, m_Simulator.GetStepTime());
+        }
+
+        m_StepIndex++;
+
+        Publish(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - stepStart).count());
+    }
+
+    void OceanSimulationThread::Publish(float stepMilliseconds)
+    {
+        OceanSnapshot& snapshot = m_Snapshots.GetWriteBuffer();
+        snapshot.Time = m_Simulator.GetStepTime();
+        snapshot.StepIndex = m_StepIndex;
+        snapshot.StepMilliseconds = stepMilliseconds;
+
+        std::copy(m_Simulator.GetHtBuffer().begin(), m_Simulator.GetHtBuffer().end(), snapshot.Ht.begin());
+        std::copy(m_Simulator.GetNormalMap().begin(), m_Simulator.GetNormalMap().end(), snapshot.NormalMap.begin());
+        std::copy(m_Simulator.GetBubbleMap().begin(), m_Simulator.GetBubbleMap().end(), snapshot.BubbleMap.begin());
+
+        if (snapshot.HeightQuery)
+        {
+            snapshot.HeightQuery->Update(snapshot.Ht.data(), m_Simulator.GetMeshSize(), m_QueryOceanSize, m_QueryLambda);
+            snapshot.HeightPyramid->Build(*snapshot.HeightQuery);
+        }
+
+        m_Snapshots.Publish();
+    }
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "VOceanEngine/TripleBuffer.h"
+#include "Renderer/HeightMap/OceanSimulatorCPU.h"
+#include "Renderer/HeightMap/OceanHeightQuery.h"
+#include "Renderer/HeightMap/OceanHeightPyramid.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace voe
+{
+    // One published result of OceanSimulationThread, laid out like OceanSimulatorCPU.
+    struct OceanSnapshot
+    {
+        // simulation time, in units of ComputeUBO::deltaT
+        float Time = 0.0f;
+        // number of the step that produced it, starting at 1
+        uint64_t StepIndex = 0;
+        // wall clock time of the step on the simulation thread
+        float StepMilliseconds = 0.0f;
+
+        std::vector<glm::vec2> Ht;
+        std::vector<glm::vec4> NormalMap;
+        std::vector<float> BubbleMap;
+
+        // built from Ht on the simulation thread, nullptr unless EnableSurfaceQueries was called
+        std::unique_ptr<OceanHeightQuery> HeightQuery;
+        std::unique_ptr<OceanHeightPyramid> HeightPyramid;
+    };
+
+    // Runs an OceanSimulatorCPU on its own thread at a fixed step rate, independent of the frame rate.
+    // Every step is published through a TripleBuffer, so the render thread picks up the latest
+    // result without blocking and a stalled frame never holds back the simulation (or the other way round).
+    // Steps use TimeStepMode::Incremental. If the thread falls behind by more than MaxLagSteps,
+    // it drops the missed steps and restarts the phases at the current time instead of catching up.
+    //
+    // After FollowSubmittedTimes the wall clock is not used: the thread steps to the times the render thread
+    // passes to SubmitStepTime, so its snapshots land on the same times as the steps of the GPU ocean.
+    class VOE_API OceanSimulationThread
+    {
+    public:
+        static constexpr uint32_t MaxLagSteps = 4;
+
+        // Called on the simulation thread after every step, before the result is published.
+        // The place for CPU side work that needs the full simulator state (queries, physics).
+        using StepCallback = std::function<void(const OceanSimulatorCPU&, float time)>;
+
+        // stepRate in steps per second, timeScale converts wall clock seconds to simulation time
+        // (HeightMap::GetAnimRate() to follow the GPU ocean).
+        // threadCount is passed to the ThreadPool of the simulator, whose calling thread is the simulation thread.
+        OceanSimulationThread(
+            uint32_t meshSize,
+            const OceanSpectrumParams& params,
+            float stepRate = 60.0f,
+            float timeScale = 1.0f,
+            uint32_t threadCount = 0);
+        ~OceanSimulationThread();
+
+        OceanSimulationThread(const OceanSimulationThread&) = delete;
+        OceanSimulationThread& operator=(const OceanSimulationThread&) = delete;
+
+        // Only while the thread is stopped.
+        void SetStepCallback(StepCallback callback);
+        void SetDispersion(const DispersionParams& params);
+        // Every snapshot gets an OceanHeightQuery and OceanHeightPyramid of its step, built before it is
+        // published so that the render thread never pays for them. oceanSize and lambda are passed to
+        // OceanHeightQuery::Update, threadCount to the ThreadPools of both (one pair per snapshot buffer).
+        void EnableSurfaceQueries(float oceanSize, float lambda, uint32_t threadCount = 0);
+        // Steps only to the times of SubmitStepTime, startTime of Start is ignored. stepRate and timeScale
+        // should match the steps of the submitting side, a step of any other length restarts the phases.
+        void FollowSubmittedTimes();
+
+        void Start(float startTime = 0.0f);
+        void Stop();
+        bool IsRunning() const { return m_Thread.joinable(); }
+
+        // Render thread. Returns the latest published step, or nullptr before the first one.
+        // The snapshot stays valid and unchanged until the next call.
+        const OceanSnapshot* AcquireLatest();
+        // Render thread, after FollowSubmittedTimes. The next step lands on time (ComputeUBO::deltaT of a GPU step).
+        // Never waits for the simulation thread: if it is still busy, only the latest time is kept and the
+        // steps in between are dropped.
+        void SubmitStepTime(float time);
+
+        float GetStepRate() const { return m_StepRate; }
+
+    private:
+        void Run();
+        void RunOnWallClock();
+        void RunOnSubmittedTimes();
+        void Step(std::chrono::steady_clock::time_point stepStart);
+        void Publish(float stepMilliseconds);
+
+        OceanSimulatorCPU m_Simulator;
+        float m_StepRate;
+        float m_TimeScale;
+        float m_StartTime = 0.0f;
+        bool m_FollowSubmittedTimes = false;
+        uint64_t m_StepIndex = 0;
+        float m_QueryOceanSize = 0.0f;
+        float m_QueryLambda = 0.0f;
+
+        StepCallback m_StepCallback;
+        TripleBuffer<OceanSnapshot> m_Snapshots;
+        bool m_HasSnapshot = false;
+
+        std::thread m_Thread;
+        std::mutex m_StopMutex;
+        std::condition_variable m_StopCondition;
+        bool m_Stop = false;
+        // guarded by m_StopMutex
+        float m_SubmittedTime = 0.0f;
+        bool m_HasSubmittedTime = false;
+    };
+}
@@ -0,0 +1,294 @@
+#include "PreCompileHeader.h"
+#include "OceanSimulatorCPU.h"
+
+#include "Renderer/HeightMap/TessendorfOceane.h"
+
+namespace voe
+{
+    namespace
+    {
+        glm::vec2 MultiplyComplex(glm::vec2 a, glm::vec2 b)
+        {
+            return glm::vec2(a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x);
+        }
+
+        glm::vec2 ComplexExp(float a)
+        {
+            return glm::vec2(std::cos(a), std::sin(a));
+        }
+
+        // rows per chunk handed to the thread pool
+        const uint32_t RowGrain = 8;
+
+        // packed position of H_y, H_x, H_z, Dx, Dz
+        const uint32_t ChannelPlanes[] = { 0, 2, 2, 1, 1 };
+        const uint32_t ChannelComponents[] = { 0, 0, 1, 0, 1 };
+    }
+
+    uint32_t OceanSimulatorCPU::GetPlane(Channel channel)
+    {
+        return ChannelPlanes[channel];
+    }
+
+    uint32_t OceanSimulatorCPU::GetComponent(Channel channel)
+    {
+        return ChannelComponents[channel];
+    }
+
+    OceanSimulatorCPU::OceanSimulatorCPU(uint32_t meshSize, const glm::vec2* h0, uint32_t threadCount, bool pinThreads)
+        : m_MeshSize(meshSize)
+    {
+        Initialize(threadCount, pinThreads);
+        std::copy(h0, h0 + m_ElementCount, m_H0.begin());
+    }
+
+    OceanSimulatorCPU::OceanSimulatorCPU(uint32_t meshSize, const OceanSpectrumParams& params, uint32_t threadCount, bool pinThreads)
+        : m_MeshSize(meshSize), m_SpectrumParams(params), m_Dispersion(ResolveDispersion(params, {}))
+    {
+        Initialize(threadCount, pinThreads);
+        GenerateOceanSpectrum(meshSize, params, m_H0);
+    }
+
+    void OceanSimulatorCPU::Initialize(uint32_t threadCount, bool pinThreads)
+    {
+        if (m_MeshSize < 2 || (m_MeshSize & (m_MeshSize - 1)) != 0)
+        {
+            throw std::runtime_error("OceanSimulatorCPU: mesh size must be a power of two");
+        }
+
+        m_ElementCount = m_MeshSize * m_MeshSize;
+        m_OceanSizeLx = TessendorfOceane<>::GetOceanSize(m_MeshSize);
+        m_OceanSizeLz = TessendorfOceane<>::GetOceanSize(m_MeshSize);
+
+        m_ThreadPool = std::make_unique<ThreadPool>(threadCount, pinThreads);
+
+        m_H0.resize(m_ElementCount);
+        m_Ht.resize(m_ElementCount * HeightMap::m_OceanPlaneCount);
+        m_NormalMap.resize(m_ElementCount);
+        m_BubbleMap.resize(m_ElementCount);
+        BuildWaveTable(m_MeshSize, m_OceanSizeLx, m_OceanSizeLz, m_Dispersion, m_Waves);
+        // filled by BeginStepping
+        m_Phases.reserve(m_ElementCount);
+
+        m_Spectrum.resize(2 * m_ElementCount * HeightMap::m_OceanPlaneCount);
+        for (uint32_t p = 0; p < HeightMap::m_OceanPlaneCount; p++)
+        {
+            m_SpectrumPlanes[p] = { &m_Spectrum[2 * p * m_ElementCount], &m_Spectrum[(2 * p + 1) * m_ElementCount] };
+        }
+
+        m_FFT = std::make_unique<BatchedFFT2D>(m_MeshSize, HeightMap::m_OceanPlaneCount, FFTDirection::Inverse, *m_ThreadPool, true);
+    }
+
+    void OceanSimulatorCPU::SetDispersion(const DispersionParams& params)
+    {
+        m_Dispersion = ResolveDispersion(m_SpectrumParams, params);
+        BuildWaveTable(m_MeshSize, m_OceanSizeLx, m_OceanSizeLz, m_Dispersion, m_Waves);
+    }
+
+    void OceanSimulatorCPU::Simulate(float time)
+    {
+        // 1: spectrum
+        m_ThreadPool->ParallelFor(m_MeshSize, RowGrain, [this, time](uint32_t begin, uint32_t end, uint32_t)
+        {
+            EvaluateSpectrum(time, nullptr, false, begin, end);
+        });
+
+        Transform();
+    }
+
+    void OceanSimulatorCPU::BeginStepping(float time, float dt)
+    {
+        InitializePhases(m_Waves, time, dt, m_Phases);
+        m_StepStartTime = time;
+        m_StepTime = time;
+        m_StepDt = dt;
+        m_StepCount = 0;
+    }
+
+    void OceanSimulatorCPU::Step()
+    {
+        if (m_Phases.empty())
+        {
+            throw std::runtime_error("OceanSimulatorCPU: Step() without BeginStepping()");
+        }
+
+        m_StepCount++;
+        m_StepTime = m_StepStartTime + m_StepCount * m_StepDt;
+        bool renormalize = m_StepCount % PhaseRenormalizeInterval == 0;
+
+        // 1: spectrum
+        m_ThreadPool->ParallelFor(m_MeshSize, RowGrain, [this, renormalize](uint32_t begin, uint32_t end, uint32_t)
+        {
+            EvaluateSpectrum(0.0f, m_Phases.data(), renormalize, begin, end);
+        });
+
+        Transform();
+    }
+
+    void OceanSimulatorCPU::Transform()
+    {
+        const uint32_t N = m_MeshSize;
+
+        // 2: FFT of all planes together (rows, then columns)
+        m_FFT->Execute(m_SpectrumPlanes.data());
+
+        m_ThreadPool->ParallelFor(N, RowGrain, [this](uint32_t begin, uint32_t end, uint32_t)
+        {
+            StoreHeights(begin, end);
+        });
+
+        // 3: normal map
+        m_ThreadPool->ParallelFor(N, RowGrain, [this](uint32_t begin, uint32_t end, uint32_t)
+        {
+            EvaluateNormals(begin, end);
+        });
+    }
+
+    void OceanSimulatorCPU::EvaluateSpectrum(float time, PhaseState* phases, bool renormalize, uint32_t rowBegin, uint32_t rowEnd)
+    {
+        const uint32_t N = m_MeshSize;
+
+        for (uint32_t y = rowBegin; y < rowEnd; y++)
+        {
+            for (uint32_t x = 0; x < N; x++)
+            {
+                uint32_t in_index = y * N + x;
+                uint32_t in_mindex = (N - y) % N * N + (N - x) % N; // mirrored
+                uint32_t out_index = y * N + x;
+
+                const WaveVector& wave = m_Waves[in_index];
+                glm::vec2 k(wave.Kx, wave.Kz);
+
+                // e^(iwt), e^(-iwt) is its conjugate
+                glm::vec2 phasor;
+                if (phases != nullptr)
+                {
+                    PhaseState& phase = phases[in_index];
+                    phasor = MultiplyComplex(phase.Phasor, phase.Step);
+                    if (renormalize)
+                    {
+                        phasor = RenormalizePhasor(phasor);
+                    }
+                    phase.Phasor = phasor;
+                }
+                else
+                {
+                    phasor = ComplexExp(wave.Omega * time);
+                }
+
+                glm::vec2 h0_k = m_H0[in_index];
+                glm::vec2 h0_mk = m_H0[in_mindex];
+
+                glm::vec2 htval =
+                    MultiplyComplex(h0_k, phasor) +
+                    MultiplyComplex(glm::vec2(h0_mk.x, -h0_mk.y), glm::vec2(phasor.x, -phasor.y));
+
+                // ht_dx, ht_dz
+                glm::vec2 htival(-htval.y, htval.x); // i*htval
+                glm::vec2 ht_dx = htival * k.x;
+                glm::vec2 ht_dz = htival * k.y;
+
+                glm::vec2 dx = -htival * (k.x * wave.InvLength);
+                glm::vec2 dz = -htival * (k.y * wave.InvLength);
+
+                // the anti-Hermitian Nyquist column (row) of the x (z) channels would leak into its partner
+                if (x == 0)
+                {
+                    ht_dx = glm::vec2(0.0f);
+                    dx = glm::vec2(0.0f);
+                }
+                if (y == 0)
+                {
+                    ht_dz = glm::vec2(0.0f);
+                    dz = glm::vec2(0.0f);
+                }
+
+                // plane 0 = (ht_y, 0), plane 1 = (dx, dz), plane 2 = (ht_dx, ht_dz)
+                glm::vec2 values[HeightMap::m_OceanPlaneCount] =
+                {
+                    htval,
+                    dx + glm::vec2(-dz.y, dz.x),
+                    ht_dx + glm::vec2(-ht_dz.y, ht_dz.x)
+                };
+
+                for (uint32_t p = 0; p < HeightMap::m_OceanPlaneCount; p++)
+                {
+                    m_SpectrumPlanes[p].Re[out_index] = values[p].x;
+                    m_SpectrumPlanes[p].Im[out_index] = values[p].y;
+                }
+            }
+        }
+    }
+
+    void OceanSimulatorCPU::StoreHeights(uint32_t rowBegin, uint32_t rowEnd)
+    {
+        const uint32_t N = m_MeshSize;
+
+        // The FFT already stores shifted like FFT.comp, which also negates every other element
+        // of each pass. In 2D that is (-1)^(x + z) on the shifted indices, the two (-1)^(N / 2)
+        // factors of the shift cancel.
+        for (uint32_t p = 0; p < HeightMap::m_OceanPlaneCount; p++)
+        {
+            const SplitPlane& plane = m_SpectrumPlanes[p];
+            glm::vec2* Ht = &m_Ht[p * m_ElementCount];
+
+            for (uint32_t y = rowBegin; y < rowEnd; y++)
+            {
+                for (uint32_t x = 0; x < N; x++)
+                {
+                    uint32_t index = y * N + x;
+                    float sign = ((x + y) & 1) ? -1.0f : 1.0f;
+                    Ht[index] = glm::vec2(plane.Re[index], plane.Im[index]) * sign;
+                }
+            }
+        }
+    }
+
+    void OceanSimulatorCPU::EvaluateNormals(uint32_t rowBegin, uint32_t rowEnd)
+    {
+        const uint32_t N = m_MeshSize;
+        const uint32_t offset = m_ElementCount; // 0 ht_y, 1 (dx, dz), 2 (ht_dx, ht_dz)
+
+        // oceanNormal.comp uses OceanSizeLx for both directions
+        float dx = 1.0f * m_OceanSizeLx / N;
+        float dz = 1.0f * m_OceanSizeLx / N;
+
+        const glm::vec2* Ht = m_Ht.data();
+
+        for (uint32_t y = rowBegin; y < rowEnd; y++)
+        {
+            uint32_t y0 = (y - 1 + N) % N;
+            uint32_t y1 = (y + 1) % N;
+
+            for (uint32_t x = 0; x < N; x++)
+            {
+                uint32_t x0 = (x - 1 + N) % N;
+                uint32_t x1 = (x + 1) % N;
+
+                // central differences
+                float dDxdx = 0.5f * (Ht[x1 + y * N + 1 * offset].x - Ht[x0 + y * N + 1 * offset].x);
+                float dDzdz = 0.5f * (Ht[x + y1 * N + 1 * offset].y - Ht[x + y0 * N + 1 * offset].y);
+                float dDxdz = 0.5f * (Ht[x + y1 * N + 1 * offset].x - Ht[x + y0 * N + 1 * offset].x);
+                float dDzdx = 0.5f * (Ht[x1 + y * N + 1 * offset].y - Ht[x0 + y * N + 1 * offset].y);
+
+                float gradx = Ht[x + y * N + 2 * offset].x;
+                float gradz = Ht[x + y * N + 2 * offset].y;
+
+                // the sample point moves with displaceXZ, so the slope is corrected here
+                gradx *= dx / (dDxdx * m_Lambda + dx);
+                gradz *= dz / (dDzdz * m_Lambda + dz);
+
+                m_NormalMap[y * N + x] = glm::vec4(glm::normalize(glm::vec3(-gradx, -1.0f, -gradz)), 1.0f);
+
+                // Jacobian
+                float Jxx = 1.0f + dDxdx * m_Lambda;
+                float Jzz = 1.0f + dDzdz * m_Lambda;
+                float Jxz = dDxdz * m_Lambda;
+                float Jzx = dDzdx * m_Lambda;
+
+                // J < 0 where the surface folds over
+                m_BubbleMap[y * N + x] = Jxx * Jzz - Jxz * Jzx;
+            }
+        }
+    }
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "VOceanEngine/BatchedFFT2D.h"
+#include "VOceanEngine/ThreadPool.h"
+#include "Renderer/HeightMap/HeightMap.h"
+#include "Renderer/HeightMap/OceanPhase.h"
+#include "Renderer/HeightMap/OceanSpectrum.h"
+
+namespace voe
+{
+    // Headless CPU version of the ocean compute pipeline.
+    // Simulate(t) runs the same steps as the GPU for a frame with ComputeUBO::deltaT = t:
+    //   spectrum.glsl    - h(k, t) and the four derived channels, evaluated by the first FFT.comp pass
+    //   FFT.comp         - row and column pass per plane (transposed, shifted stores)
+    //   oceanNormal.comp - normal map and Jacobian (bubble) map
+    // The buffers have the same layout as HtBuffers (packed planes, see HeightMap::m_OceanPlaneCount)
+    // and the two storage images, so a GPU readback can be compared element by element.
+    // The FFT itself is a natural order BatchedFFT2D over all planes, so the results match
+    // FFT.comp up to rounding rather than bit for bit.
+    // Nothing is allocated after construction.
+    class VOE_API OceanSimulatorCPU
+    {
+    public:
+        // Channels in the order of HeightMap::Ocean.
+        enum Channel : uint32_t
+        {
+            H_y = 0,
+            H_x,
+            H_z,
+            Dx,
+            Dz
+        };
+
+        // Spatial values of one channel. The channels are packed two per complex plane,
+        // so consecutive elements are two floats apart.
+        struct ChannelView
+        {
+            const float* Data;
+
+            float operator[](uint32_t index) const { return Data[index * 2]; }
+        };
+
+        // Plane and component (0 = x, 1 = y) of every channel in HtBuffers.
+        static uint32_t GetPlane(Channel channel);
+        static uint32_t GetComponent(Channel channel);
+
+        // meshSize has to be a power of two. h0 holds meshSize * meshSize bins.
+        // threadCount and pinThreads are passed to the ThreadPool.
+        OceanSimulatorCPU(uint32_t meshSize, const glm::vec2* h0, uint32_t threadCount = 0, bool pinThreads = false);
+        // Generates h0 with GenerateOceanSpectrum first.
+        OceanSimulatorCPU(uint32_t meshSize, const OceanSpectrumParams& params, uint32_t threadCount = 0, bool pinThreads = false);
+        ~OceanSimulatorCPU() = default;
+
+        void Simulate(float time);
+
+        // TimeStepMode::Incremental: starts at time with fixed steps of dt. Every Step() then
+        // advances by dt without trig per bin. Simulate(t) still works in between and leaves the
+        // phases alone.
+        void BeginStepping(float time, float dt);
+        void Step();
+        // time of the last Step()
+        float GetStepTime() const { return m_StepTime; }
+
+        // Rebuilds the wave table, the next Simulate / BeginStepping uses the new w(k).
+        // params goes through ResolveDispersion with the spectrum h0 was generated from.
+        void SetDispersion(const DispersionParams& params);
+        const DispersionParams& GetDispersion() const { return m_Dispersion; }
+
+        // ComputeUBO::lamda, the choppiness used for the normal and Jacobian.
+        void SetLambda(float lambda) { m_Lambda = lambda; }
+
+        uint32_t GetMeshSize() const { return m_MeshSize; }
+        uint32_t GetOceanSizeLx() const { return m_OceanSizeLx; }
+        uint32_t GetOceanSizeLz() const { return m_OceanSizeLz; }
+
+        // meshSize * meshSize elements each, row major (z rows, x columns).
+        ChannelView GetChannel(Channel channel) const
+        {
+            return { &m_Ht[GetPlane(channel) * m_ElementCount].x + GetComponent(channel) };
+        }
+        // All packed planes back to back, like HtBuffers.
+        const std::vector<glm::vec2>& GetHtBuffer() const { return m_Ht; }
+        const std::vector<glm::vec4>& GetNormalMap() const { return m_NormalMap; }
+        const std::vector<float>& GetBubbleMap() const { return m_BubbleMap; }
+        const std::vector<glm::vec2>& GetH0Buffer() const { return m_H0; }
+
+    private:
+        void Initialize(uint32_t threadCount, bool pinThreads);
+
+        // Runs every pass after the spectrum was written.
+        void Transform();
+        // spectrum.glsl for the rows [rowBegin, rowEnd), phases != nullptr steps them instead of using time
+        void EvaluateSpectrum(float time, PhaseState* phases, bool renormalize, uint32_t rowBegin, uint32_t rowEnd);
+        // FFT result -> Ht with the sign and order of FFT.comp, rows [rowBegin, rowEnd)
+        void StoreHeights(uint32_t rowBegin, uint32_t rowEnd);
+        // oceanNormal.comp for the rows [rowBegin, rowEnd)
+        void EvaluateNormals(uint32_t rowBegin, uint32_t rowEnd);
+
+        uint32_t m_MeshSize;
+        uint32_t m_ElementCount;
+        uint32_t m_OceanSizeLx;
+        uint32_t m_OceanSizeLz;
+        float m_Lambda = 1.0f;
+
+        std::vector<glm::vec2> m_H0;
+        std::vector<glm::vec2> m_Ht;
+        std::vector<glm::vec4> m_NormalMap;
+        std::vector<float> m_BubbleMap;
+
+        // default (Phillips) when h0 was passed in
+        OceanSpectrumParams m_SpectrumParams;
+        DispersionParams m_Dispersion;
+        std::vector<WaveVector> m_Waves;
+
+        std::vector<PhaseState> m_Phases;
+        float m_StepStartTime = 0.0f;
+        float m_StepTime = 0.0f;
+        float m_StepDt = 0.0f;
+        uint32_t m_StepCount = 0;
+
+        // the packed planes as split re / im arrays, transformed in place
+        std::vector<float> m_Spectrum;
+        std::array<SplitPlane, HeightMap::m_OceanPlaneCount> m_SpectrumPlanes;
+
+        std::unique_ptr<ThreadPool> m_ThreadPool;
+        std::unique_ptr<BatchedFFT2D> m_FFT;
+    };
+}
@@ -0,0 +1,321 @@
+#pragma once
+
+#include <cmath>
+
+// Spectrum and directional spreading policies for TessendorfOceane.
+// A spectrum policy gives the variance P(k) of one frequency bin without direction,
+// a spreading policy the directional factor D(k). The h0 amplitude of a bin is
+// sqrt(P * D / 2) * (z0 + i z1).
+// Frequency spectra S(w) are converted to the wave number domain with
+// S(k) = S(w) * dw/dk / k and multiplied by the bin area dkx * dkz.
+// (see Horvath, "Empirical directional wave spectra for computer graphics", 2015)
+
+namespace voe
+{
+    enum class SpectrumModel : uint32_t
+    {
+        Phillips = 0,
+        PiersonMoskowitz,
+        Jonswap,
+        TMA
+    };
+
+    enum class SpreadingModel : uint32_t
+    {
+        // |k . w|^2 term of the original Phillips spectrum
+        PhillipsCos2 = 0,
+        // Mitsuyasu cos-2s
+        Cos2s,
+        DonelanBanner
+    };
+
+    // Runtime parameters of the sea state. The models themselves are selected at
+    // compile time (see GenerateOceanSpectrum), these values only feed them.
+    struct OceanSpectrumParams
+    {
+        SpectrumModel Spectrum = SpectrumModel::Phillips;
+        SpreadingModel Spreading = SpreadingModel::PhillipsCos2;
+
+        // gravitational constant
+        float G = 9.81f;
+        // wave scale factor  A - constant (Phillips)
+        float A = 0.00000161f;
+        // wind speed [m/s] and direction [rad]
+        float WindSpeed = 30.0f;
+        float WindDir = glm::pi<float>() / 3.0f;
+        // distance over which the wind blows [m] (JONSWAP, TMA)
+        float Fetch = 300000.0f;
+        // peak enhancement factor gamma (JONSWAP, TMA)
+        float PeakEnhancement = 3.3f;
+        // water depth [m] (TMA)
+        float Depth = 40.0f;
+
+        // The same seed always reproduces the same sea state.
+        uint64_t Seed = 1234;
+    };
+
+    // Per bin values shared by the spectrum and the spreading policies.
+    struct WaveBin
+    {
+        float K2;           // |k|^2
+        float K;            // |k|
+        float Omega;        // angular frequency from the dispersion relation
+        float DOmegaDk;     // group velocity dw/dk
+        float CosTheta;     // cosine of the angle between k and the wind
+    };
+
+    namespace spectrum
+    {
+        // S(w) [m^2 s] -> variance of a bin in the wave number domain
+        inline float FrequencyToBin(float S, const WaveBin& bin, float dkArea)
+        {
+            return S * bin.DOmegaDk / bin.K * dkArea;
+        }
+
+        // alpha g^2 / w^5 exp(-5/4 (wp / w)^4)
+        inline float PiersonMoskowitzShape(float alpha, float g, float omega, float peakOmega)
+        {
+            float r = peakOmega / omega;
+            float r2 = r * r;
+            return alpha * g * g / std::pow(omega, 5.0f) * std::exp(-1.25f * r2 * r2);
+        }
+
+        inline float JonswapPeakOmega(const OceanSpectrumParams& params)
+        {
+            return 22.0f * std::cbrt(params.G * params.G / (params.WindSpeed * params.Fetch));
+        }
+
+        inline float JonswapAlpha(const OceanSpectrumParams& params)
+        {
+            return 0.076f * std::pow(params.WindSpeed * params.WindSpeed / (params.Fetch * params.G), 0.22f);
+        }
+
+        inline float JonswapPeakEnhancement(float gamma, float omega, float peakOmega)
+        {
+            float sigma = omega <= peakOmega ? 0.07f : 0.09f;
+            float d = omega - peakOmega;
+            return std::pow(gamma, std::exp(-d * d / (2.0f * sigma * sigma * peakOmega * peakOmega)));
+        }
+    }
+
+    // ------------------------------------------------------------------
+    // Spectrum policies
+    // ------------------------------------------------------------------
+
+    // Phillips spectrum, A exp(-1 / (k L)^2) / k^4 with the small wave damping exp(-k^2 l^2).
+    struct PhillipsSpectrum
+    {
+        static constexpr bool FiniteDepth = false;
+
+        struct Context
+        {
+            float A;
+            float L;
+            float l2;
+        };
+
+        static Context Prepare(const OceanSpectrumParams& params, float dkArea)
+        {
+            // largest possible wave from constant wind of velocity v
+            float L = params.WindSpeed * params.WindSpeed / params.G;
+            return { params.A, L, (L / 1000) * (L / 1000) };
+        }
+
+        static float PeakOmega(const OceanSpectrumParams& params)
+        {
+            return 0.855f * params.G / params.WindSpeed;
+        }
+
+        static float Evaluate(const Context& c, const WaveBin& bin)
+        {
+            float phillips = c.A * std::exp(-1.0f / (bin.K2 * c.L * c.L)) / (bin.K2 * bin.K2);
+
+            // damp out waves with very small length w << l
+            return phillips * std::exp(-bin.K2 * c.l2);
+        }
+    };
+
+    // Fully developed sea.
+    struct PiersonMoskowitzSpectrum
+    {
+        static constexpr bool FiniteDepth = false;
+
+        struct Context
+        {
+            float G;
+            float PeakOmega;
+            float DkArea;
+        };
+
+        static Context Prepare(const OceanSpectrumParams& params, float dkArea)
+        {
+            return { params.G, PeakOmega(params), dkArea };
+        }
+
+        static float PeakOmega(const OceanSpectrumParams& params)
+        {
+            return 0.855f * params.G / params.WindSpeed;
+        }
+
+        static float Evaluate(const Context& c, const WaveBin& bin)
+        {
+            float S = spectrum::PiersonMoskowitzShape(0.0081f, c.G, bin.Omega, c.PeakOmega);
+            return spectrum::FrequencyToBin(S, bin, c.DkArea);
+        }
+    };
+
+    // Fetch limited sea (Hasselmann et al. 1973).
+    struct JonswapSpectrum
+    {
+        static constexpr bool FiniteDepth = false;
+
+        struct Context
+        {
+            float G;
+            float Alpha;
+            float PeakOmega;
+            float Gamma;
+            float DkArea;
+        };
+
+        static Context Prepare(const OceanSpectrumParams& params, float dkArea)
+        {
+            return { params.G, spectrum::JonswapAlpha(params), PeakOmega(params), params.PeakEnhancement, dkArea };
+        }
+
+        static float PeakOmega(const OceanSpectrumParams& params)
+        {
+            return spectrum::JonswapPeakOmega(params);
+        }
+
+        static float Evaluate(const Context& c, const WaveBin& bin)
+        {
+            float S = spectrum::PiersonMoskowitzShape(c.Alpha, c.G, bin.Omega, c.PeakOmega)
+                * spectrum::JonswapPeakEnhancement(c.Gamma, bin.Omega, c.PeakOmega);
+            return spectrum::FrequencyToBin(S, bin, c.DkArea);
+        }
+    };
+
+    // JONSWAP with the Kitaigorodskii depth attenuation (Bouws et al. 1985).
+    struct TMASpectrum
+    {
+        static constexpr bool FiniteDepth = true;
+
+        struct Context
+        {
+            JonswapSpectrum::Context Jonswap;
+            float SqrtDepthOverG;
+        };
+
+        static Context Prepare(const OceanSpectrumParams& params, float dkArea)
+        {
+            return { JonswapSpectrum::Prepare(params, dkArea), std::sqrt(params.Depth / params.G) };
+        }
+
+        static float PeakOmega(const OceanSpectrumParams& params)
+        {
+            return spectrum::JonswapPeakOmega(params);
+        }
+
+        static float Evaluate(const Context& c, const WaveBin& bin)
+        {
+            float omegaH = bin.Omega * c.SqrtDepthOverG;
+            float phi = 1.0f;
+            if (omegaH <= 1.0f)
+            {
+                phi = 0.5f * omegaH * omegaH;
+            }
+            else if (omegaH < 2.0f)
+            {
+                phi = 1.0f - 0.5f * (2.0f - omegaH) * (2.0f - omegaH);
+            }
+            return JonswapSpectrum::Evaluate(c.Jonswap, bin) * phi;
+        }
+    };
+
+    // ------------------------------------------------------------------
+    // Directional spreading policies
+    // ------------------------------------------------------------------
+
+    struct PhillipsSpreading
+    {
+        struct Context {};
+
+        static Context Prepare(const OceanSpectrumParams& params, float peakOmega)
+        {
+            return {};
+        }
+
+        static float Evaluate(const Context& c, const WaveBin& bin)
+        {
+            return bin.CosTheta * bin.CosTheta;
+        }
+    };
+
+    // Q(s) |cos(theta / 2)|^2s with the frequency dependent s of Mitsuyasu et al. (1975).
+    struct Cos2sSpreading
+    {
+        struct Context
+        {
+            float PeakOmega;
+            float PeakS;
+        };
+
+        static Context Prepare(const OceanSpectrumParams& params, float peakOmega)
+        {
+            float peakS = 11.5f * std::pow(params.G / (peakOmega * params.WindSpeed), 2.5f);
+            return { peakOmega, peakS };
+        }
+
+        static float Evaluate(const Context& c, const WaveBin& bin)
+        {
+            float r = bin.Omega / c.PeakOmega;
+            float s = r <= 1.0f ? c.PeakS * std::pow(r, 5.0f) : c.PeakS * std::pow(r, -2.5f);
+
+            // normalization 2^(2s-1) / pi * Gamma(s+1)^2 / Gamma(2s+1)
+            float logQ = (2.0f * s - 1.0f) * 0.69314718f - 1.14472989f
+                + 2.0f * std::lgamma(s + 1.0f) - std::lgamma(2.0f * s + 1.0f);
+
+            // |cos(theta / 2)|^2 = (1 + cos(theta)) / 2
+            float halfCos2 = std::max(0.5f * (1.0f + bin.CosTheta), 0.0f);
+            return std::exp(logQ) * std::pow(halfCos2, s);
+        }
+    };
+
+    // beta / (2 tanh(beta pi)) sech^2(beta theta) (Donelan et al. 1985, Banner 1990).
+    struct DonelanBannerSpreading
+    {
+        struct Context
+        {
+            float PeakOmega;
+        };
+
+        static Context Prepare(const OceanSpectrumParams& params, float peakOmega)
+        {
+            return { peakOmega };
+        }
+
+        static float Evaluate(const Context& c, const WaveBin& bin)
+        {
+            float r = bin.Omega / c.PeakOmega;
+            float beta;
+            if (r < 0.95f)
+            {
+                beta = 2.61f * std::pow(r, 1.3f);
+            }
+            else if (r < 1.6f)
+            {
+                beta = 2.28f * std::pow(r, -1.3f);
+            }
+            else
+            {
+                float epsilon = -0.4f + 0.8393f * std::exp(-0.567f * std::log(r * r));
+                beta = std::pow(10.0f, epsilon);
+            }
+
+            float theta = std::acos(std::min(std::max(bin.CosTheta, -1.0f), 1.0f));
+            float sech = 1.0f / std::cosh(beta * theta);
+            return beta / (2.0f * std::tanh(beta * glm::pi<float>())) * sech * sech;
+        }
+    };
+}
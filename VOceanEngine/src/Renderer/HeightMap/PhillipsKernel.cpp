@@ -0,0 +1,159 @@
+#include "PreCompileHeader.h"
+#include "PhillipsKernel.h"
+
+namespace voe
+{
+    namespace
+    {
+        // Processes count bins (count must be a multiple of F::Width).
+        template<typename F>
+        void GenerateBatch(
+            const OceanSpectrumParams& params,
+            const float* kx,
+            float ky,
+            const float* u1,
+            const float* u2,
+            float* h0,
+            uint32_t count)
+        {
+            const float L = params.WindSpeed * params.WindSpeed / params.G;
+            const float l2 = (L / 1000) * (L / 1000);
+
+            const F vKy = F::Set1(ky);
+            const F vL = F::Set1(L);
+            const F vA = F::Set1(params.A);
+            const F vNegL2 = F::Set1(-l2);
+            const F vWindCos = F::Set1(glm::cos(params.WindDir));
+            const F vWindSin = F::Set1(glm::sin(params.WindDir));
+            const F vZero = F::Zero();
+            const F vOne = F::Set1(1.0f);
+            const F vHalf = F::Set1(0.5f);
+            const F vMinusTwo = F::Set1(-2.0f);
+            const F vTwoPi = F::Set1(2.0f * glm::pi<float>());
+
+            for (uint32_t i = 0; i < count; i += F::Width)
+            {
+                F vKx = F::Load(kx + i);
+
+                // wave number magnitude
+                F k2mag = vKx * vKx + vKy * vKy;
+                F isDC = CmpEq(k2mag, vZero);
+                k2mag = Select(isDC, vOne, k2mag);
+                F k4mag = k2mag * k2mag;
+                F kmag = Sqrt(k2mag);
+
+                // wind alignment
+                F w_dot_k = (vKx / kmag) * vWindCos + (vKy / kmag) * vWindSin;
+
+                F phillips = vA * simd::Exp((vZero - vOne) / (k2mag * vL * vL)) / k4mag * w_dot_k * w_dot_k;
+
+                // damp out waves with very small length w << l
+                phillips = phillips * simd::Exp(k2mag * vNegL2);
+                phillips = Select(isDC, vZero, phillips);
+
+                F amplitude = Sqrt(phillips * vHalf);
+
+                // Box-Muller
+                F mag = Sqrt(vMinusTwo * simd::Log(F::Load(u1 + i)));
+                F s, c;
+                simd::SinCos(vTwoPi * F::Load(u2 + i), s, c);
+
+                simd::StoreInterleaved(h0 + 2 * i, amplitude * mag * c, amplitude * mag * s);
+            }
+        }
+
+        // Runs the vector kernel over the whole row. The tail is padded to a full vector so
+        // that every bin goes through the same instructions whatever the vector width is.
+        template<typename F>
+        void GenerateRowSimd(
+            const OceanSpectrumParams& params,
+            const float* kx,
+            float ky,
+            const float* u1,
+            const float* u2,
+            glm::vec2* h0,
+            uint32_t count)
+        {
+            uint32_t bulk = count - count % F::Width;
+            GenerateBatch<F>(params, kx, ky, u1, u2, &h0[0].x, bulk);
+
+            if (bulk == count)
+            {
+                return;
+            }
+
+            float tailKx[F::Width] = {};
+            float tailU1[F::Width];
+            float tailU2[F::Width];
+            float tailH0[F::Width * 2];
+            for (uint32_t i = 0; i < F::Width; i++)
+            {
+                bool valid = bulk + i < count;
+                tailKx[i] = valid ? kx[bulk + i] : 0.0f;
+                tailU1[i] = valid ? u1[bulk + i] : 0.5f;
+                tailU2[i] = valid ? u2[bulk + i] : 0.5f;
+            }
+
+            GenerateBatch<F>(params, tailKx, ky, tailU1, tailU2, tailH0, F::Width);
+
+            for (uint32_t i = bulk; i < count; i++)
+            {
+                h0[i] = glm::vec2(tailH0[(i - bulk) * 2], tailH0[(i - bulk) * 2 + 1]);
+            }
+        }
+    }
+
+    void PhillipsKernel::GenerateRow(
+        const OceanSpectrumParams& params,
+        const float* kx,
+        float ky,
+        const float* u1,
+        const float* u2,
+        glm::vec2* h0,
+        uint32_t count,
+        simd::SimdLevel level)
+    {
+        switch (level)
+        {
+        case simd::SimdLevel::AVX2:
+            GenerateRowSimd<simd::Float8>(params, kx, ky, u1, u2, h0, count);
+            _mm256_zeroupper();
+            break;
+        case simd::SimdLevel::SSE:
+            GenerateRowSimd<simd::Float4>(params, kx, ky, u1, u2, h0, count);
+            break;
+        default:
+            GenerateRowScalar(params, kx, ky, u1, u2, h0, count);
+            break;
+        }
+    }
+
+    void PhillipsKernel::GenerateRowScalar(
+        const OceanSpectrumParams& params,
+        const float* kx,
+        float ky,
+        const float* u1,
+        const float* u2,
+        glm::vec2* h0,
+        uint32_t count)
+    {
+        PhillipsSpectrum::Context spectrum = PhillipsSpectrum::Prepare(params, 0.0f);
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            float k2mag = kx[i] * kx[i] + ky * ky;
+            if (k2mag == 0.0f)
+            {
+                h0[i] = glm::vec2(0.0f);
+                continue;
+            }
+
+            WaveBin bin = {};
+            bin.K2 = k2mag;
+            bin.CosTheta = (kx[i] * glm::cos(params.WindDir) + ky * glm::sin(params.WindDir)) / glm::sqrt(k2mag);
+
+            float P = PhillipsSpectrum::Evaluate(spectrum, bin) * PhillipsSpreading::Evaluate({}, bin);
+            h0[i] = glm::sqrt(P * 0.5f) * BoxMuller(u1[i], u2[i]);
+        }
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "VOceanEngine/SimdMath.h"
+#include "Renderer/HeightMap/OceanSpectrum.h"
+
+namespace voe
+{
+    // Evaluates h0(k) = sqrt(P(k) / 2) * (z0 + i z1) for a batch of wave vectors,
+    // where P is PhillipsSpectrum * PhillipsSpreading and (z0, z1) a Box-Muller Gaussian pair.
+    // The SSE (4 lanes) and AVX2 (8 lanes) paths give bit-identical results.
+    class VOE_API PhillipsKernel
+    {
+    public:
+        // Max |h0_simd - h0_scalar| / |h0_scalar| of the SIMD paths against GenerateRowScalar.
+        static constexpr float Tolerance = 1e-6f;
+
+        // Box-Muller transform of two uniform numbers in (0, 1).
+        static glm::vec2 BoxMuller(float u1, float u2)
+        {
+            constexpr float two_pi = 2.0f * glm::pi<float>();
+
+            float mag = glm::sqrt(-2.0f * glm::log(u1));
+            return glm::vec2(mag * glm::cos(two_pi * u2), mag * glm::sin(two_pi * u2));
+        }
+
+        // kx, u1, u2 and h0 hold count elements. All bins of the batch share ky.
+        static void GenerateRow(
+            const OceanSpectrumParams& params,
+            const float* kx,
+            float ky,
+            const float* u1,
+            const float* u2,
+            glm::vec2* h0,
+            uint32_t count,
+            simd::SimdLevel level = simd::GetSimdLevel());
+
+        // Reference implementation with the standard library functions.
+        static void GenerateRowScalar(
+            const OceanSpectrumParams& params,
+            const float* kx,
+            float ky,
+            const float* u1,
+            const float* u2,
+            glm::vec2* h0,
+            uint32_t count);
+    };
+}
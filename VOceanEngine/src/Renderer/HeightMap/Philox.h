@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace voe
+{
+    // Philox4x32-10 counter-based random number generator.
+    // (Salmon et al. "Parallel Random Numbers: As Easy as 1, 2, 3", SC11)
+    // The output depends only on (counter, key), so every ocean bin can draw its
+    // own random numbers without shared state and independent of thread scheduling.
+    class Philox4x32
+    {
+    public:
+        using Counter = std::array<uint32_t, 4>;
+        using Key = std::array<uint32_t, 2>;
+
+        static Counter Generate(Counter counter, Key key)
+        {
+            for (uint32_t round = 0; round < 10; round++)
+            {
+                counter = Round(counter, key);
+                key[0] += W0;
+                key[1] += W1;
+            }
+            return counter;
+        }
+
+        static Key MakeKey(uint64_t seed)
+        {
+            return { static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32) };
+        }
+
+        // Maps a 32-bit integer to a float in the open interval (0, 1).
+        // Only the upper 24 bits are used so the result is exact in single precision.
+        static float ToUniformOpenFloat(uint32_t value)
+        {
+            return (static_cast<float>(value >> 8) + 0.5f) * (1.0f / 16777216.0f);
+        }
+
+    private:
+        static Counter Round(const Counter& ctr, const Key& key)
+        {
+            uint64_t p0 = static_cast<uint64_t>(M0) * ctr[0];
+            uint64_t p1 = static_cast<uint64_t>(M1) * ctr[2];
+
+            uint32_t hi0 = static_cast<uint32_t>(p0 >> 32);
+            uint32_t lo0 = static_cast<uint32_t>(p0);
+            uint32_t hi1 = static_cast<uint32_t>(p1 >> 32);
+            uint32_t lo1 = static_cast<uint32_t>(p1);
+
+            return { hi1 ^ ctr[1] ^ key[0], lo1, hi0 ^ ctr[3] ^ key[1], lo0 };
+        }
+
+        static constexpr uint32_t M0 = 0xD2511F53;
+        static constexpr uint32_t M1 = 0xCD9E8D57;
+        static constexpr uint32_t W0 = 0x9E3779B9;
+        static constexpr uint32_t W1 = 0xBB67AE85;
+    };
+}
@@ -0,0 +1,135 @@
+#include "PreCompileHeader.h"
+#include "SpectrumCache.h"
+
+#include <filesystem>
+
+namespace voe
+{
+    namespace
+    {
+        struct Fnv1a
+        {
+            uint64_t Hash = 0xcbf29ce484222325ull;
+
+            template<typename T>
+            void Add(const T& value)
+            {
+                const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+                for (size_t i = 0; i < sizeof(T); i++)
+                {
+                    Hash ^= bytes[i];
+                    Hash *= 0x100000001b3ull;
+                }
+            }
+        };
+    }
+
+    SpectrumCache::SpectrumCache(const std::string& directory)
+        : m_Directory(directory)
+    {
+    }
+
+    uint64_t SpectrumCache::MakeKey(uint32_t meshSize, uint32_t lx, uint32_t lz, const OceanSpectrumParams& params)
+    {
+        // hash the fields one by one, the padding of OceanSpectrumParams is undefined
+        Fnv1a fnv;
+        fnv.Add(Version);
+        fnv.Add(meshSize);
+        fnv.Add(lx);
+        fnv.Add(lz);
+        fnv.Add(params.Spectrum);
+        fnv.Add(params.Spreading);
+        fnv.Add(params.G);
+        fnv.Add(params.A);
+        fnv.Add(params.WindSpeed);
+        fnv.Add(params.WindDir);
+        fnv.Add(params.Fetch);
+        fnv.Add(params.PeakEnhancement);
+        fnv.Add(params.Depth);
+        fnv.Add(params.Seed);
+        return fnv.Hash;
+    }
+
+    std::string SpectrumCache::GetPath(uint64_t key) const
+    {
+        std::stringstream ss;
+        ss << m_Directory << "/h0_" << std::hex << std::setw(16) << std::setfill('0') << key << ".bin";
+        return ss.str();
+    }
+
+    const glm::vec2* SpectrumCache::Load(uint32_t meshSize, uint32_t lx, uint32_t lz, const OceanSpectrumParams& params)
+    {
+        uint64_t key = MakeKey(meshSize, lx, lz, params);
+        std::string path = GetPath(key);
+
+        if (!m_File.Open(path, MappedFile::Access::Read))
+        {
+            return nullptr;
+        }
+
+        size_t dataSize = static_cast<size_t>(meshSize) * meshSize * sizeof(glm::vec2);
+        const Header* header = static_cast<const Header*>(m_File.GetData());
+
+        bool valid = m_File.GetSize() == sizeof(Header) + dataSize
+            && header->Magic == Magic
+            && header->Version == Version
+            && header->Key == key
+            && header->MeshSize == meshSize
+            && header->OceanSizeLx == lx
+            && header->OceanSizeLz == lz
+            && header->ElementSize == sizeof(glm::vec2);
+
+        if (!valid)
+        {
+            VOE_CORE_WARN("Ignoring stale h0 cache file {0}", path);
+            m_File.Close();
+            return nullptr;
+        }
+
+        return reinterpret_cast<const glm::vec2*>(header + 1);
+    }
+
+    bool SpectrumCache::Store(uint32_t meshSize, uint32_t lx, uint32_t lz, const OceanSpectrumParams& params, const glm::vec2* h0)
+    {
+        uint64_t key = MakeKey(meshSize, lx, lz, params);
+        std::string path = GetPath(key);
+
+        // write to a temporary file first so that a crash never leaves a truncated cache entry behind
+        std::string tempPath = path + ".tmp";
+        size_t dataSize = static_cast<size_t>(meshSize) * meshSize * sizeof(glm::vec2);
+
+        std::error_code ec;
+        std::filesystem::create_directories(m_Directory, ec);
+
+        {
+            MappedFile file;
+            if (!file.Open(tempPath, MappedFile::Access::Create, sizeof(Header) + dataSize))
+            {
+                VOE_CORE_WARN("Failed to create h0 cache file {0}", tempPath);
+                return false;
+            }
+
+            Header header = { Magic, Version, key, meshSize, lx, lz, sizeof(glm::vec2) };
+            std::memcpy(file.GetData(), &header, sizeof(Header));
+            std::memcpy(static_cast<uint8_t*>(file.GetData()) + sizeof(Header), h0, dataSize);
+
+            if (!file.Flush())
+            {
+                VOE_CORE_WARN("Failed to write h0 cache file {0}", tempPath);
+                file.Close();
+                std::filesystem::remove(tempPath, ec);
+                return false;
+            }
+        }
+
+        std::filesystem::rename(tempPath, path, ec);
+        if (ec)
+        {
+            // another instance may hold the file mapped, its copy is just as good
+            std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "VOceanEngine/MappedFile.h"
+#include "Renderer/HeightMap/OceanSpectrum.h"
+
+namespace voe
+{
+    // On-disk cache of generated h0 spectra.
+    // Every sea state (mesh size, ocean size, spectrum params and seed) is stored in its own
+    // file named after a hash of those values. A hit is memory-mapped and can be copied
+    // straight into the staging buffer without generating anything on the CPU.
+    class VOE_API SpectrumCache
+    {
+    public:
+        // "VOH0"
+        static constexpr uint32_t Magic = 0x30484F56;
+        // Bump when the file layout or the h0 generation changes, older files are then ignored.
+        static constexpr uint32_t Version = 1;
+
+        struct Header
+        {
+            uint32_t Magic;
+            uint32_t Version;
+            uint64_t Key;
+            uint32_t MeshSize;
+            uint32_t OceanSizeLx;
+            uint32_t OceanSizeLz;
+            uint32_t ElementSize;
+        };
+        static_assert(sizeof(Header) == 32, "h0 data has to start 32 bytes into the file");
+
+        SpectrumCache(const std::string& directory = "Assets/Cache");
+        ~SpectrumCache() = default;
+
+        // Returns the mapped h0 (meshSize * meshSize elements) or nullptr on a miss.
+        // The pointer stays valid until the next Load or the destruction of the cache.
+        const glm::vec2* Load(uint32_t meshSize, uint32_t lx, uint32_t lz, const OceanSpectrumParams& params);
+
+        // Writes h0 to the cache. Failures are logged and otherwise ignored.
+        bool Store(uint32_t meshSize, uint32_t lx, uint32_t lz, const OceanSpectrumParams& params, const glm::vec2* h0);
+
+        // Stable across runs and builds (FNV-1a over the individual values).
+        static uint64_t MakeKey(uint32_t meshSize, uint32_t lx, uint32_t lz, const OceanSpectrumParams& params);
+
+    private:
+        std::string GetPath(uint64_t key) const;
+
+        std::string m_Directory;
+        MappedFile m_File;
+    };
+}
@@ -1,106 +1,214 @@
 #pragma once
 
-#include "Renderer/HeightMap/HeightMap.h"
+#include "Renderer/HeightMap/OceanSpectrum.h"
+#include "Renderer/HeightMap/Philox.h"
+#include "Renderer/HeightMap/PhillipsKernel.h"
+
+#include <thread>
+#include <type_traits>
 
 namespace voe
 {
-    class VOE_API TessendorfOceane
+    // Spectrum - one of the spectrum policies in OceanSpectrum.h (PhillipsSpectrum, JonswapSpectrum, ...)
+    // Spreading - one of the directional spreading policies (PhillipsSpreading, Cos2sSpreading, ...)
+    // Every combination is its own class, so the per-bin kernel is fully inlined.
+    template<typename Spectrum = PhillipsSpectrum, typename Spreading = PhillipsSpreading>
+    class TessendorfOceane
     {
     public:
 
-        TessendorfOceane(uint32_t size) 
-            : m_MeshSize(size), m_OceanSizeLx(size * 5 / 2), m_OceanSizeLz(size * 5 / 2)
+        TessendorfOceane(uint32_t size, const OceanSpectrumParams& params = {})
+            : m_MeshSize(size), m_OceanSizeLx(GetOceanSize(size)), m_OceanSizeLz(GetOceanSize(size)),
+              m_Params(params), m_Key(Philox4x32::MakeKey(params.Seed))
         {
-            
+            float dkArea = (2.0f * glm::pi<float>() / m_OceanSizeLx) * (2.0f * glm::pi<float>() / m_OceanSizeLz);
+            m_SpectrumContext = Spectrum::Prepare(m_Params, dkArea);
+            m_SpreadingContext = Spreading::Prepare(m_Params, Spectrum::PeakOmega(m_Params));
         }
 
         ~TessendorfOceane() = default;
 
+        // Side length of the simulated patch for a grid of meshSize^2 bins.
+        static uint32_t GetOceanSize(uint32_t meshSize) { return meshSize * 5 / 2; }
+
         // Generates Gaussian random number with mean 0 and standard deviation 1.
-        glm::vec2 GaussianRanndomNum()
+        // The pair is derived from (seed, x, y) only, so the same seed always gives
+        // the same spectrum regardless of how the rows are split across threads.
+        glm::vec2 GaussianRanndomNum(uint32_t x, uint32_t y) const
         {
-            constexpr float epsilon = std::numeric_limits<float>::epsilon();
-            constexpr float two_pi = 2.0 * glm::pi<float>();
+            float u1, u2;
+            UniformPair(x, y, u1, u2);
+            return PhillipsKernel::BoxMuller(u1, u2);
+        }
 
-            //initialize the random uniform number generator (runif) in a range 0 to 1
-            static std::mt19937 rng(std::random_device{}()); // Standard mersenne_twister_engine seeded with rd()
-            static std::uniform_real_distribution<> runif(0.0, 1.0);
+        // Variance P(k) * D(k) of the bin with wave vector (Kx, Ky)
+        float EvaluateSpectrum(float Kx, float Ky) const
+        {
+            float k2mag = Kx * Kx + Ky * Ky;
 
-            //create two random numbers, make sure u1 is greater than epsilon
-            double u1, u2;
-            do
+            if (k2mag == 0.0f)
             {
-                u1 = runif(rng);
-                u2 = runif(rng);
-            } while (u1 <= epsilon);
+                return 0.0f;
+            }
 
-            //compute z0 and z1
-            auto mag = sqrt(-2.0 * log(u1));
-            auto z0 = mag * cos(two_pi * u2);
-            auto z1 = mag * sin(two_pi * u2);
+            WaveBin bin;
+            bin.K2 = k2mag;
+            bin.K = glm::sqrt(k2mag);
+            bin.CosTheta = (Kx * glm::cos(m_Params.WindDir) + Ky * glm::sin(m_Params.WindDir)) / bin.K;
 
-            return glm::vec2(z0, z1);
+            // dispersion relation
+            if constexpr (Spectrum::FiniteDepth)
+            {
+                float kh = bin.K * m_Params.Depth;
+                float th = std::tanh(kh);
+                bin.Omega = glm::sqrt(m_Params.G * bin.K * th);
+                bin.DOmegaDk = m_Params.G * (th + kh * (1.0f - th * th)) / (2.0f * bin.Omega);
+            }
+            else
+            {
+                bin.Omega = glm::sqrt(m_Params.G * bin.K);
+                bin.DOmegaDk = m_Params.G / (2.0f * bin.Omega);
+            }
+
+            return Spectrum::Evaluate(m_SpectrumContext, bin) * Spreading::Evaluate(m_SpreadingContext, bin);
         }
 
-        // Phillips spectrum
-        // (Kx, Ky) - normalized wave vector
-        float GeneratePhillipsSpectrum(float Kx, float Ky)
+        // Generate base heightfield in frequency space.
+        // Rows are split across threadCount workers (0 = hardware concurrency).
+        void Generate(std::vector<glm::vec2>& h0Buffer, uint32_t threadCount = 0)
         {
-            float k2mag = Kx * Kx + Ky * Ky;
+            if (threadCount == 0)
+            {
+                threadCount = std::max(1u, std::thread::hardware_concurrency());
+            }
+            threadCount = std::min(threadCount, m_MeshSize);
 
-            if (k2mag == 0.0f)
+            if (threadCount == 1)
             {
-                return 0.0f;
+                GenerateRows(h0Buffer, 0, m_MeshSize);
+                return;
             }
-            float k4mag = k2mag * k2mag;
 
-            // largest possible wave from constant wind of velocity v
-            float L = windSpeed * windSpeed / G;
+            std::vector<std::thread> workers;
+            workers.reserve(threadCount);
 
-            float k_x = Kx / glm::sqrt(k2mag);
-            float k_y = Ky / glm::sqrt(k2mag);
-            float w_dot_k = k_x * glm::cos(windDir) + k_y * glm::sin(windDir);
+            uint32_t rowsPerThread = (m_MeshSize + threadCount - 1) / threadCount;
+            for (uint32_t begin = 0; begin < m_MeshSize; begin += rowsPerThread)
+            {
+                uint32_t end = std::min(begin + rowsPerThread, m_MeshSize);
+                workers.emplace_back([this, &h0Buffer, begin, end]() { GenerateRows(h0Buffer, begin, end); });
+            }
 
-            float phillips = A * glm::exp(-1.0f / (k2mag * L * L)) / k4mag * w_dot_k * w_dot_k;
+            for (auto& worker : workers)
+            {
+                worker.join();
+            }
+        }
 
-            // damp out waves with very small length w << l
-            float l2 = (L / 1000) * (L / 1000);
-            phillips *= glm::exp(-k2mag * l2);
-            return phillips;
+        const OceanSpectrumParams& GetParams() const { return m_Params; }
+
+        // Ocean params
+        const uint32_t m_MeshSize;
+        const uint32_t m_OceanSizeLx;
+        const uint32_t m_OceanSizeLz;
+
+    private:
+        // The classic Phillips combination has a dedicated SIMD kernel.
+        static constexpr bool UseBatchKernel =
+            std::is_same_v<Spectrum, PhillipsSpectrum> && std::is_same_v<Spreading, PhillipsSpreading>;
+
+        // Two uniform numbers in (0, 1) for the bin (x, y).
+        void UniformPair(uint32_t x, uint32_t y, float& u1, float& u2) const
+        {
+            Philox4x32::Counter counter = { x, y, 0, 0 };
+            Philox4x32::Counter random = Philox4x32::Generate(counter, m_Key);
+
+            u1 = Philox4x32::ToUniformOpenFloat(random[0]);
+            u2 = Philox4x32::ToUniformOpenFloat(random[1]);
         }
 
-        // Generate base heightfield in frequency space
-        void Generate(std::vector<glm::vec2>& h0Buffer)
+        void GenerateRows(std::vector<glm::vec2>& h0Buffer, uint32_t rowBegin, uint32_t rowEnd) const
         {
-            for (uint32_t y = 0; y < m_MeshSize; y++)
+            std::vector<float> kx(m_MeshSize);
+            std::vector<float> u1(m_MeshSize);
+            std::vector<float> u2(m_MeshSize);
+
+            for (uint32_t x = 0; x < m_MeshSize; x++)
             {
+                kx[x] = (-(int)m_MeshSize / 2.0f + x) * (2.0f * glm::pi<float>() / m_OceanSizeLx);
+            }
+
+            for (uint32_t y = rowBegin; y < rowEnd; y++)
+            {
+                float ky = (-(int)m_MeshSize / 2.0f + y) * (2.0f * glm::pi<float>() / m_OceanSizeLz);
+
                 for (uint32_t x = 0; x < m_MeshSize; x++)
                 {
-                    float kx = (-(int)m_MeshSize / 2.0f + x) * (2.0f * glm::pi<float>() / m_OceanSizeLx);
-                    float ky = (-(int)m_MeshSize / 2.0f + y) * (2.0f * glm::pi<float>() / m_OceanSizeLz);
-                    float P = GeneratePhillipsSpectrum(kx, ky);
+                    UniformPair(x, y, u1[x], u2[x]);
+                }
+
+                glm::vec2* row = &h0Buffer[y * m_MeshSize];
 
-                    if (kx == 0.0f && ky == 0.0f)
+                if constexpr (UseBatchKernel)
+                {
+                    // the kernel returns 0 for the DC bin (kx == 0 && ky == 0)
+                    PhillipsKernel::GenerateRow(m_Params, kx.data(), ky, u1.data(), u2.data(), row, m_MeshSize);
+                }
+                else
+                {
+                    for (uint32_t x = 0; x < m_MeshSize; x++)
                     {
-                        P = 0.0f;
+                        float P = EvaluateSpectrum(kx[x], ky);
+                        row[x] = glm::sqrt(P * 0.5f) * PhillipsKernel::BoxMuller(u1[x], u2[x]);
                     }
-                    h0Buffer[y * m_MeshSize + x] = glm::sqrt(P * 0.5f) * GaussianRanndomNum();
                 }
             }
         }
 
-        // Ocean params
-        const uint32_t m_MeshSize;
-        const uint32_t m_OceanSizeLx;
-        const uint32_t m_OceanSizeLz;
+        const OceanSpectrumParams m_Params;
+        const Philox4x32::Key m_Key;
 
-    private:
-        // gravitational constant
-        const float G = 9.81f;  
-        // wave scale factor  A - constant
-        const float A = 0.00000161f;
-        const float windSpeed = 30.0f;
-        const float windDir = glm::pi<float>() / 3.0f;
+        typename Spectrum::Context m_SpectrumContext;
+        typename Spreading::Context m_SpreadingContext;
     };
-}
 
+    namespace detail
+    {
+        template<typename Spectrum>
+        void GenerateOceanSpectrum(uint32_t size, const OceanSpectrumParams& params, std::vector<glm::vec2>& h0Buffer)
+        {
+            switch (params.Spreading)
+            {
+            case SpreadingModel::Cos2s:
+                TessendorfOceane<Spectrum, Cos2sSpreading>(size, params).Generate(h0Buffer);
+                break;
+            case SpreadingModel::DonelanBanner:
+                TessendorfOceane<Spectrum, DonelanBannerSpreading>(size, params).Generate(h0Buffer);
+                break;
+            default:
+                TessendorfOceane<Spectrum, PhillipsSpreading>(size, params).Generate(h0Buffer);
+                break;
+            }
+        }
+    }
+
+    // Fills h0Buffer (size * size bins) with the spectrum and spreading models selected in params.
+    inline void GenerateOceanSpectrum(uint32_t size, const OceanSpectrumParams& params, std::vector<glm::vec2>& h0Buffer)
+    {
+        switch (params.Spectrum)
+        {
+        case SpectrumModel::PiersonMoskowitz:
+            detail::GenerateOceanSpectrum<PiersonMoskowitzSpectrum>(size, params, h0Buffer);
+            break;
+        case SpectrumModel::Jonswap:
+            detail::GenerateOceanSpectrum<JonswapSpectrum>(size, params, h0Buffer);
+            break;
+        case SpectrumModel::TMA:
+            detail::GenerateOceanSpectrum<TMASpectrum>(size, params, h0Buffer);
+            break;
+        default:
+            detail::GenerateOceanSpectrum<PhillipsSpectrum>(size, params, h0Buffer);
+            break;
+        }
+    }
+}
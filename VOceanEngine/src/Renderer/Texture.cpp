@@ -52,6 +52,7 @@ namespace voe {
 	* @param (Optional) filter Texture filtering for the sampler (defaults to VK_FILTER_LINEAR)
 	* @param (Optional) imageUsageFlags Usage flags for the texture's image (defaults to VK_IMAGE_USAGE_SAMPLED_BIT)
 	* @param (Optional) imageLayout Usage layout for the texture (defaults VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+	* @param (Optional) sharingMode VK_SHARING_MODE_CONCURRENT shares the image between the graphics and compute queues (defaults to VK_SHARING_MODE_EXCLUSIVE)
 	*/
 
 	Texture2D::Texture2D()
@@ -80,7 +81,8 @@ namespace voe {
 		VkQueue copyQueue,
 		VkFilter filter,
 		VkImageUsageFlags imageUsageFlags,
-		VkImageLayout imageLayout)
+		VkImageLayout imageLayout,
+		VkSharingMode sharingMode)
 	{
 		m_Device = &device;
 		m_Width = texWidth;
@@ -147,6 +149,15 @@ namespace voe {
 		imageCreateInfo.extent = { m_Width, m_Height, 1 };
 		imageCreateInfo.usage = imageUsageFlags;
 
+		// concurrent between the graphics and compute queues, only needed if they are different families
+		uint32_t queueFamilies[] = { device.GetGraphicsQueueFamily(), device.GetComputeQueueFamily() };
+		if (sharingMode == VK_SHARING_MODE_CONCURRENT && queueFamilies[0] != queueFamilies[1])
+		{
+			imageCreateInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+			imageCreateInfo.queueFamilyIndexCount = 2;
+			imageCreateInfo.pQueueFamilyIndices = queueFamilies;
+		}
+
 		// Ensure that the TRANSFER_DST bit is set for staging
 		if (!(imageCreateInfo.usage & VK_IMAGE_USAGE_TRANSFER_DST_BIT))
 		{
@@ -56,6 +56,7 @@ namespace voe {
 			VkQueue				copyQueue,
 			VkFilter			filter = VK_FILTER_LINEAR,
 			VkImageUsageFlags	imageUsageFlags = VK_IMAGE_USAGE_SAMPLED_BIT,
-			VkImageLayout		imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+			VkImageLayout		imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			VkSharingMode		sharingMode = VK_SHARING_MODE_EXCLUSIVE);
 	};
 }
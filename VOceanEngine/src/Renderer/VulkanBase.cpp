@@ -2,10 +2,11 @@
 
 #include "Renderer/VulkanBase.h"
 #include "VulkanCore/VulkanCoreHeader.h"
+#include "Renderer/HeightMap/HeightMap.h"
 
 namespace voe {
 
-	VulkanBase::VulkanBase(std::shared_ptr<Window> window) : m_Window(window)
+	VulkanBase::VulkanBase(std::shared_ptr<Window> window, uint32_t oceanGridSize) : m_Window(window), m_OceanGridSize(oceanGridSize)
 	{
 		InitVulkanDevice();
 		CreateSwapchain();
@@ -151,7 +152,7 @@ namespace voe {
 
 	void VulkanBase::CreateVulkanRenderer()
 	{
-		m_Renderer = std::make_unique<VulkanRenderer>(*m_Device, m_Swapchain->GetRenderPass());
+		m_Renderer = std::make_unique<VulkanRenderer>(*m_Device, m_Swapchain->GetRenderPass(), m_OceanGridSize);
 	}
 
 	void VulkanBase::CreateImguiRenderer()
@@ -266,6 +267,22 @@ namespace voe {
 		VkSemaphore compCompleteSemaphore = m_Renderer->GetComputeSemaphores().Complete;
 		std::array<VkCommandBuffer, 2> compCmbs = m_Renderer->GetComputeCommandBuffer();
 
+		// With a fixed ocean step rate most frames skip the compute chain and only draw
+		// from the history buffer, they don't wait for the compute semaphore.
+		// A baked loop replaces the chain with the upload of its next frame.
+		HeightMap& heightMap = m_Renderer->GetOceanHeightMap();
+		bool dispatchCompute = heightMap.IsStepPending();
+		std::array<VkCommandBuffer, 2> computeSubmitCmbs = {
+			compCmbs[m_CurrentFrameIndex],
+			m_Renderer->GetHistoryCopyCommandBuffer(heightMap.GetHistorySlot()) };
+		uint32_t computeSubmitCount = static_cast<uint32_t>(computeSubmitCmbs.size());
+
+		if (heightMap.IsPlaying())
+		{
+			computeSubmitCmbs[0] = m_Renderer->GetPlaybackUploadCommandBuffer(heightMap.GetHistorySlot());
+			computeSubmitCount = 1;
+		}
+
 		VkSemaphore imageTransCompleteSemaphore = m_Renderer->GetImageTransitionSemaphores().Complete;
 		VkSemaphore imageTransReadySemaphore = m_Renderer->GetImageTransitionSemaphores().Ready;
 		std::array<VkCommandBuffer, 2> imageTransCmbs = m_Renderer->GetImageTransitionCommandBuffer();
@@ -275,7 +292,9 @@ namespace voe {
 
 		static bool firstDraw = true;
 		
-		VkPipelineStageFlags computeWaitDstStageMask[] = { VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT };
+		// the dispatches and copies of a step overwrite the normal and bubble images, which the frames
+		// drawn since the previous step may still sample
+		VkPipelineStageFlags computeWaitDstStageMask[] = { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT };
 		
 		// first draw
 		VkSubmitInfo imageTransSubmitInfo = {};
@@ -288,8 +307,8 @@ namespace voe {
 		computeSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 		computeSubmitInfo.signalSemaphoreCount = 1;
 		computeSubmitInfo.pSignalSemaphores = &compCompleteSemaphore;
-		computeSubmitInfo.commandBufferCount = 1;
-		computeSubmitInfo.pCommandBuffers = &compCmbs[m_CurrentFrameIndex];
+		computeSubmitInfo.commandBufferCount = computeSubmitCount;
+		computeSubmitInfo.pCommandBuffers = computeSubmitCmbs.data();
 
 		if (!firstDraw)
 		{
@@ -304,14 +323,25 @@ namespace voe {
 			imageTransSubmitInfo.signalSemaphoreCount = 1;
 			imageTransSubmitInfo.pSignalSemaphores = &imageTransCompleteSemaphore;	*/	
 		}
-		else
-		{
-			firstDraw = false;
-		}
 
 		// submit order is imageTrans->Compute	
 		//VOE_CHECK_RESULT(vkQueueSubmit(m_Device->GetComputeQueue(), 1, &imageTransSubmitInfo, VK_NULL_HANDLE));
-		VOE_CHECK_RESULT(vkQueueSubmit(m_Device->GetComputeQueue(), 1, &computeSubmitInfo, VK_NULL_HANDLE));
+		if (dispatchCompute)
+		{
+			VOE_CHECK_RESULT(vkQueueSubmit(m_Device->GetComputeQueue(), 1, &computeSubmitInfo, VK_NULL_HANDLE));
+		}
+		else if (!firstDraw)
+		{
+			// Every graphics submit signals compReadySemaphore, so that the next step waits for all the
+			// frames drawn until then. A frame without a step only consumes the signal.
+			VkSubmitInfo computeWaitSubmitInfo = {};
+			computeWaitSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			computeWaitSubmitInfo.waitSemaphoreCount = 1;
+			computeWaitSubmitInfo.pWaitSemaphores = computeWaitSemaphores;
+			computeWaitSubmitInfo.pWaitDstStageMask = computeWaitDstStageMask;
+
+			VOE_CHECK_RESULT(vkQueueSubmit(m_Device->GetComputeQueue(), 1, &computeWaitSubmitInfo, VK_NULL_HANDLE));
+		}
 
 		VkPipelineStageFlags waitDstStageMask[2] = {
 			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT
@@ -326,7 +356,7 @@ namespace voe {
 
 		VkSubmitInfo submitInfo = {};
 		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-		submitInfo.waitSemaphoreCount = 2;
+		submitInfo.waitSemaphoreCount = dispatchCompute ? 2 : 1;
 		submitInfo.pWaitSemaphores = waitSemaphores;
 		submitInfo.pWaitDstStageMask = waitDstStageMask;
 		submitInfo.commandBufferCount = 1;
@@ -336,6 +366,7 @@ namespace voe {
 
 		vkResetFences(m_Device->GetVkDevice(), 1, &m_InFlightFences[m_CurrentFrameIndex]);
 		VOE_CHECK_RESULT(vkQueueSubmit(m_Device->GetGraphicsQueue(), 1, &submitInfo, m_InFlightFences[m_CurrentFrameIndex]));
+		firstDraw = false;
 				
 		VkSwapchainKHR swapChains[] = { m_Swapchain->GetSwapchain() };
 
@@ -15,7 +15,8 @@ namespace voe{
 	class VOE_API VulkanBase
 	{
 	public:
-		VulkanBase(std::shared_ptr<Window> window);
+		// oceanGridSize is passed to VulkanRenderer, see VulkanRenderer::MinGridSize / MaxGridSize
+		VulkanBase(std::shared_ptr<Window> window, uint32_t oceanGridSize = VulkanRenderer::DefaultGridSize);
 		~VulkanBase();
 		VulkanBase(const VulkanBase&) = delete;
 		VulkanBase& operator=(const VulkanBase&) = delete;
@@ -66,6 +67,7 @@ namespace voe{
 		void DestroyCommandBuffers();
 		
 		std::shared_ptr<Window> m_Window;
+		uint32_t m_OceanGridSize;
 
 		std::unique_ptr<Instance>	m_Instance;
 		std::unique_ptr<Surface>	m_Surface;
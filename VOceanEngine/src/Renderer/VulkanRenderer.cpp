@@ -4,6 +4,7 @@
 #include "VulkanCore/Device.h"
 #include "Renderer/Descriptor.h"
 #include "Renderer/HeightMap/HeightMap.h"
+#include "Renderer/HeightMap/OceanLoop.h"
 
 #include "Renderer/Camera.h"
 #include "Renderer/GameObject.h"
@@ -35,8 +36,13 @@ namespace voe {
 		glm::vec3 CameraPos{ 0.0f, 0.0f, 0.0f };
 	};
 
-	VulkanRenderer::VulkanRenderer(Device& device, VkRenderPass renderPass) : m_Device{ device } 
+	VulkanRenderer::VulkanRenderer(Device& device, VkRenderPass renderPass, uint32_t gridSize) : m_Device{ device }, m_GroupSize{ gridSize }
 	{
+		if (gridSize < MinGridSize || gridSize > MaxGridSize || (gridSize & (gridSize - 1)) != 0)
+		{
+			throw std::runtime_error("VulkanRenderer: grid size must be a power of two from 64 to 1024");
+		}
+
 		InitDescriptors();
 		CreateGraphicsUbo();
 		CreatePipelineCache();
@@ -75,11 +81,13 @@ namespace voe {
 
 	void VulkanRenderer::RenderGameObjects(FrameInfo frameInfo, std::vector<GameObject>& gameObjects)
 	{
-		// Acquire barrier
-		AddComputeToGraphicsBarriers(frameInfo.CommandBuffer, frameInfo.FrameIndex);
-
 		m_GraphicsPipeline->Bind(frameInfo.CommandBuffer);
 
+		// ComputeUBO (binding 1) and InterpolationUBO (binding 5) of this frame
+		std::array<uint32_t, 2> dynamicOffsets = {
+			m_OceanHeightMap->GetUniformBufferOffset(frameInfo.FrameIndex),
+			m_OceanHeightMap->GetInterpolationBufferOffset(frameInfo.FrameIndex) };
+
 		vkCmdBindDescriptorSets(
 			frameInfo.CommandBuffer,
 			VK_PIPELINE_BIND_POINT_GRAPHICS,
@@ -87,8 +95,8 @@ namespace voe {
 			0,
 			1,
 			&m_GraphicsDescriptorSet,
-			0,
-			0);
+			static_cast<uint32_t>(dynamicOffsets.size()),
+			dynamicOffsets.data());
 
 		for (auto& obj : gameObjects)
 		{
@@ -107,15 +115,13 @@ namespace voe {
 			obj.m_Model->Bind(frameInfo.CommandBuffer);
 			obj.m_Model->Draw(frameInfo.CommandBuffer);
 		}
-
-		// Acquire barrier
-		AddGraphicsToComputeBarriers(frameInfo.CommandBuffer, frameInfo.FrameIndex);
 	}
 
 	void VulkanRenderer::InitOceanHeightMap()
 	{
 		m_OceanHeightMap = std::make_unique<HeightMap>(m_Device, m_Device.GetComputeQueue());
 		m_OceanHeightMap->CreateHeightMap(m_GroupSize);
+		m_OceanHeightMap->SetFixedStepRate(m_OceanFixedStepRate);
 	}
 
 	void VulkanRenderer::InitDescriptors()
@@ -169,47 +175,47 @@ namespace voe {
 
 	void VulkanRenderer::CreateDescriptorSets()
 	{
-		m_DescriptorSets.resize(11);
-		m_DescriptorSetLayouts.resize(11);
+		m_DescriptorSets.resize(3);
+		m_DescriptorSetLayouts.resize(3);
 		uint32_t descriptorIndex = 0;
 
 		// m_DescriptorSets[0]
-		// for spectrum.comp (Calculate Phillips spectrum, partial derivative, and displacement in x,y direction)
-		// and oceanNormal.comp
+		// for spectrum.glsl (Calculate Phillips spectrum, partial derivative, and displacement in x,y direction),
+		// evaluated by the horizontal FFT pass, and oceanNormal.comp
 		DescriptorBuilder::Begin(m_DescriptorLayoutCache, m_DescriptorAllocator)
 			.BindBuffer(0, m_OceanHeightMap->GetH0BufferDscInfo(), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
 			.BindBuffer(1, m_OceanHeightMap->GetHtBufferDscInfo(), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
 			.BindBuffer(2, m_OceanHeightMap->GetHt_dmyBufferDscInfo(), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
-			.BindBuffer(3, m_OceanHeightMap->GetUniformBufferDscInfo(), VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.BindBuffer(3, m_OceanHeightMap->GetUniformBufferDscInfo(), VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_SHADER_STAGE_COMPUTE_BIT)
 			.BindImage(4, m_OceanHeightMap->GetOceanNormalTextureDscInfo(), VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT)
 			.BindImage(5, m_OceanHeightMap->GetOceanBubbleTextureDscInfo(), VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT)
+			.BindBuffer(6, m_OceanHeightMap->GetPhaseBufferDscInfo(), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.BindBuffer(7, m_OceanHeightMap->GetWaveBufferDscInfo(), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
 			.Build(m_DescriptorSets[descriptorIndex], m_DescriptorSetLayouts[descriptorIndex]);
 
 		++descriptorIndex;
 
-		// for FFT calculations. Specify individual elements of the Ocean structure.
-		for (uint32_t index = 0; index < HeightMap::m_OceanElementCount; index++)
-		{
-			// m_DescriptorSets - H_y [1], H_dx [3], H_dz [5], dx [7], dy [9]
-			assert(descriptorIndex < m_DescriptorSets.size());
-			DescriptorBuilder::Begin(m_DescriptorLayoutCache, m_DescriptorAllocator)
-				.BindBuffer(0, m_OceanHeightMap->GetHtBufferDscInfos(index), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
-				.BindBuffer(1, m_OceanHeightMap->GetHt_dmyBufferDscInfos(index), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
-				.BindBuffer(2, m_OceanHeightMap->GetUniformBufferDscInfo(), VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
-				.Build(m_DescriptorSets[descriptorIndex], m_DescriptorSetLayouts[descriptorIndex]);
-
-			++descriptorIndex;
-
-			// m_DescriptorSets - Hdmy_y [2], H_dmydx [4], H_dmydz [6], dmydx [8], dmydy [10]
-			assert(descriptorIndex < m_DescriptorSets.size());
-			DescriptorBuilder::Begin(m_DescriptorLayoutCache, m_DescriptorAllocator)
-				.BindBuffer(0, m_OceanHeightMap->GetHt_dmyBufferDscInfos(index), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
-				.BindBuffer(1, m_OceanHeightMap->GetHtBufferDscInfos(index), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
-				.BindBuffer(2, m_OceanHeightMap->GetUniformBufferDscInfo(), VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
-				.Build(m_DescriptorSets[descriptorIndex], m_DescriptorSetLayouts[descriptorIndex]);
-
-			++descriptorIndex;		
-		}
+		// for FFT calculations. Every plane of the packed Ocean channels is transformed in the same dispatch,
+		// the shaders pick their plane with gl_WorkGroupID.y.
+		// m_DescriptorSets[1] - HtBuffers to Ht_dmyBuffers (horizontal)
+		DescriptorBuilder::Begin(m_DescriptorLayoutCache, m_DescriptorAllocator)
+			.BindBuffer(0, m_OceanHeightMap->GetHtBufferDscInfo(), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.BindBuffer(1, m_OceanHeightMap->GetHt_dmyBufferDscInfo(), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.BindBuffer(2, m_OceanHeightMap->GetUniformBufferDscInfo(), VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_SHADER_STAGE_COMPUTE_BIT)
+			.BindBuffer(3, m_OceanHeightMap->GetTwiddleBufferDscInfo(), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.BindBuffer(4, m_OceanHeightMap->GetBitReverseBufferDscInfo(), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.Build(m_DescriptorSets[descriptorIndex], m_DescriptorSetLayouts[descriptorIndex]);
+
+		++descriptorIndex;
+
+		// m_DescriptorSets[2] - Ht_dmyBuffers back to HtBuffers (vertical)
+		DescriptorBuilder::Begin(m_DescriptorLayoutCache, m_DescriptorAllocator)
+			.BindBuffer(0, m_OceanHeightMap->GetHt_dmyBufferDscInfo(), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.BindBuffer(1, m_OceanHeightMap->GetHtBufferDscInfo(), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.BindBuffer(2, m_OceanHeightMap->GetUniformBufferDscInfo(), VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_SHADER_STAGE_COMPUTE_BIT)
+			.BindBuffer(3, m_OceanHeightMap->GetTwiddleBufferDscInfo(), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.BindBuffer(4, m_OceanHeightMap->GetBitReverseBufferDscInfo(), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.Build(m_DescriptorSets[descriptorIndex], m_DescriptorSetLayouts[descriptorIndex]);
 	}
 
 	void VulkanRenderer::SetupFFTOceanComputePipelines()
@@ -217,6 +223,16 @@ namespace voe {
 		auto device = m_Device.GetVkDevice();
 		m_SpecializedComputeQueue = IsComputeQueueSpecialized();
 
+		const VkPhysicalDeviceLimits& limits = m_Device.GetPhDevice().GetProperties().limits;
+		uint32_t fftGroupSize = m_GroupSize / 2;
+		if (fftGroupSize > limits.maxComputeWorkGroupSize[0]
+			|| fftGroupSize > limits.maxComputeWorkGroupInvocations
+			|| !IsFFTKernelSupported(m_FFTKernel))
+		{
+			throw std::runtime_error("VulkanRenderer: the FFT of a row doesn't fit into one workgroup on this device");
+		}
+		m_RowGroupSize = std::min(m_GroupSize, 256u);
+
 		InitOceanHeightMap();
 
 		// create and build ocean descriptorsets
@@ -229,24 +245,20 @@ namespace voe {
 		pipelineLayoutCreateInfo.pSetLayouts = m_DescriptorSetLayouts.data();
 		VOE_CHECK_RESULT(vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, nullptr, &m_ComputePipelineLayout));
 		
-		// create compute pipeline
-		m_ComputePipeline = std::make_unique<ComputePipeline>(
-			m_Device,
-			"Assets/Shaders/spectrum.spv",
-			m_ComputePipelineLayout,
-			m_PipelineCache);
+		// oceanNormal.comp: workgroup width (constant 0)
+		VkSpecializationMapEntry rowEntry = { 0, 0, sizeof(uint32_t) };
+		VkSpecializationInfo rowSpecialization = { 1, &rowEntry, sizeof(uint32_t), &m_RowGroupSize };
 
-		m_FFTComputePipeline = std::make_unique<ComputePipeline>(
-			m_Device,
-			"Assets/Shaders/FFT.spv",
-			m_ComputePipelineLayout,
-			m_PipelineCache);
+		// create compute pipeline
+		m_FFTSpectrumComputePipeline = CreateFFTComputePipeline(m_FFTKernel, true);
+		m_FFTComputePipeline = CreateFFTComputePipeline(m_FFTKernel, false);
 
 		m_ComputeNormalPipeline = std::make_unique<ComputePipeline>(
 			m_Device,
 			"Assets/Shaders/oceanNormal.spv",
 			m_ComputePipelineLayout,
-			m_PipelineCache);
+			m_PipelineCache,
+			&rowSpecialization);
 
 		// Separate command pool as queue family for compute may be different than graphics
 		VkCommandPoolCreateInfo cmdPoolInfo = {};
@@ -263,6 +275,13 @@ namespace voe {
 		commandBufferAllocateInfo.commandBufferCount = m_ComputeCommandBuffers.size();
 		VOE_CHECK_RESULT(vkAllocateCommandBuffers(device, &commandBufferAllocateInfo, &m_ComputeCommandBuffers[0]));
 
+		commandBufferAllocateInfo.commandBufferCount = m_HistoryCopyCommandBuffers.size();
+		VOE_CHECK_RESULT(vkAllocateCommandBuffers(device, &commandBufferAllocateInfo, &m_HistoryCopyCommandBuffers[0]));
+
+		// recorded once a loop is played back, the staging buffer doesn't exist before
+		commandBufferAllocateInfo.commandBufferCount = m_PlaybackUploadCommandBuffers.size();
+		VOE_CHECK_RESULT(vkAllocateCommandBuffers(device, &commandBufferAllocateInfo, &m_PlaybackUploadCommandBuffers[0]));
+
 		// Semaphores for graphics / compute synchronization
 		VkSemaphoreCreateInfo semaphoreCreateInfo = {};
 		semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
@@ -271,6 +290,7 @@ namespace voe {
 
 		// Build a single command buffer containing the compute dispatch commands
 		BuildComputeCommandBuffer();
+		BuildHistoryCopyCommandBuffers();
 	}
 
 	void VulkanRenderer::SetupImageTransitionCommand()
@@ -307,8 +327,7 @@ namespace voe {
 		cmdBufInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 		cmdBufInfo.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
 
-		m_OceanHeightMap->GetOceanBubbleTexture(0).UpdateDescriptorImageLayout(VK_IMAGE_LAYOUT_GENERAL);
-		m_OceanHeightMap->GetOceanBubbleTexture(1).UpdateDescriptorImageLayout(VK_IMAGE_LAYOUT_GENERAL);
+		m_OceanHeightMap->GetOceanBubbleTexture().UpdateDescriptorImageLayout(VK_IMAGE_LAYOUT_GENERAL);
 
 		for (uint32_t index = 0; index < 2; index++)
 		{
@@ -323,7 +342,7 @@ namespace voe {
 			imageMemoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
 			imageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 			imageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
-			imageMemoryBarrier.image = m_OceanHeightMap->GetOceanBubbleImage(index);
+			imageMemoryBarrier.image = m_OceanHeightMap->GetOceanBubbleImage();
 			imageMemoryBarrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
 
 			vkCmdPipelineBarrier(
@@ -354,58 +373,36 @@ namespace voe {
 			// Create an image barrier object
 			VkImageMemoryBarrier bubbleImageMemoryBarrier = {};
 			bubbleImageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-			bubbleImageMemoryBarrier.srcQueueFamilyIndex = m_Device.GetComputeQueueFamily();
-			bubbleImageMemoryBarrier.dstQueueFamilyIndex = m_Device.GetComputeQueueFamily();
+			bubbleImageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			bubbleImageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 			bubbleImageMemoryBarrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
 			bubbleImageMemoryBarrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
 			bubbleImageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
 			bubbleImageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
-			bubbleImageMemoryBarrier.image = m_OceanHeightMap->GetOceanBubbleImage(index);
+			bubbleImageMemoryBarrier.image = m_OceanHeightMap->GetOceanBubbleImage();
 			bubbleImageMemoryBarrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
 
 			imageMemoryBarriers.push_back(bubbleImageMemoryBarrier);
 
 			VkImageMemoryBarrier NormalImageMemoryBarrier = {};
 			NormalImageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-			NormalImageMemoryBarrier.srcQueueFamilyIndex = m_Device.GetComputeQueueFamily();
-			NormalImageMemoryBarrier.dstQueueFamilyIndex = m_Device.GetComputeQueueFamily();
+			NormalImageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			NormalImageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 			NormalImageMemoryBarrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
 			NormalImageMemoryBarrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
 			NormalImageMemoryBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
 			NormalImageMemoryBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
-			NormalImageMemoryBarrier.image = m_OceanHeightMap->GetOceanNormalImage(index);
+			NormalImageMemoryBarrier.image = m_OceanHeightMap->GetOceanNormalImage();
 			NormalImageMemoryBarrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
 
 			imageMemoryBarriers.push_back(NormalImageMemoryBarrier);
-			
-			AddGraphicsToComputeBarriers(m_ComputeCommandBuffers[index], index);
-
-			// 1: Calculate philips spectrum
-			m_ComputePipeline->Bind(m_ComputeCommandBuffers[index]);
-			vkCmdBindDescriptorSets(m_ComputeCommandBuffers[index], VK_PIPELINE_BIND_POINT_COMPUTE, m_ComputePipelineLayout, 0, 1, &m_DescriptorSets[0], 0, 0);
-			vkCmdDispatch(m_ComputeCommandBuffers[index], 1, m_GroupSize, 1);
-			AddComputeToComputeBarriers(m_ComputeCommandBuffers[index], m_OceanHeightMap->GetH0Buffer(index), m_OceanHeightMap->GetHtBuffer(index));
-
-			m_FFTComputePipeline->Bind(m_ComputeCommandBuffers[index]);
-			
-			// Calculate wave heights(H_y), displacements(dx, dz), and partial derivatives(H_x,H_z) with FFT
-			for (uint32_t descriptorIndex = 1; descriptorIndex < m_DescriptorSets.size();)
-			{
-				// 2-1: Calculate FFT in horizontal direction
-				vkCmdBindDescriptorSets(m_ComputeCommandBuffers[index], VK_PIPELINE_BIND_POINT_COMPUTE, m_ComputePipelineLayout, 1, 1, &m_DescriptorSets[descriptorIndex], 0, 0);
-				vkCmdDispatch(m_ComputeCommandBuffers[index], m_GroupSize, 1, 1);
-				++descriptorIndex;
 
-				AddComputeToComputeBarriers(m_ComputeCommandBuffers[index], m_OceanHeightMap->GetHtBuffer(index), m_OceanHeightMap->GetHt_dmyBuffer(index));
+			// ComputeUBO of the frame this command buffer is submitted in
+			uint32_t uniformOffset = m_OceanHeightMap->GetUniformBufferOffset(index);
 
-				// 2-2: Calculate FFT in vertical direction
-				vkCmdBindDescriptorSets(m_ComputeCommandBuffers[index], VK_PIPELINE_BIND_POINT_COMPUTE, m_ComputePipelineLayout, 1, 1, &m_DescriptorSets[descriptorIndex], 0, 0);
-				vkCmdDispatch(m_ComputeCommandBuffers[index], m_GroupSize, 1, 1);
-				++descriptorIndex;
+			// 1, 2: Calculate philips spectrum, then wave heights(H_y), displacements(dx, dz), and partial derivatives(H_x,H_z) with FFT
+			RecordFFTDispatches(m_ComputeCommandBuffers[index], *m_FFTSpectrumComputePipeline, *m_FFTComputePipeline, index);
 
-				AddComputeToComputeBarriers(m_ComputeCommandBuffers[index], m_OceanHeightMap->GetHtBuffer(index), m_OceanHeightMap->GetHt_dmyBuffer(index));
-			}
-		
 			vkCmdPipelineBarrier(
 				m_ComputeCommandBuffers[index],
 				VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
@@ -417,42 +414,318 @@ namespace voe {
 
 			// 3: Calculate NormalMap
 			m_ComputeNormalPipeline->Bind(m_ComputeCommandBuffers[index]);
-			vkCmdBindDescriptorSets(m_ComputeCommandBuffers[index], VK_PIPELINE_BIND_POINT_COMPUTE, m_ComputePipelineLayout, 0, 1, &m_DescriptorSets[0], 0, 0);
-			vkCmdDispatch(m_ComputeCommandBuffers[index], 1, m_GroupSize, 1);
-
-			AddComputeToGraphicsBarriers(m_ComputeCommandBuffers[index], index);
+			vkCmdBindDescriptorSets(m_ComputeCommandBuffers[index], VK_PIPELINE_BIND_POINT_COMPUTE, m_ComputePipelineLayout, 0, 1, &m_DescriptorSets[0], 1, &uniformOffset);
+			vkCmdDispatch(m_ComputeCommandBuffers[index], m_GroupSize / m_RowGroupSize, m_GroupSize, 1);
 
 			VOE_CHECK_RESULT(vkEndCommandBuffer(m_ComputeCommandBuffers[index]));
 		}
 	}
 
-	void VulkanRenderer::AddGraphicsToComputeBarriers(VkCommandBuffer commandBuffer, uint32_t index)
+	void VulkanRenderer::RecordFFTDispatches(VkCommandBuffer commandBuffer, ComputePipeline& spectrumPipeline, ComputePipeline& pipeline, uint32_t index)
+	{
+		uint32_t uniformOffset = m_OceanHeightMap->GetUniformBufferOffset(index);
+
+		// 1, 2-1: Evaluate the spectrum of a row and calculate FFT of its planes in horizontal direction,
+		// a row per workgroup. Set 0 holds h0, the phases and the wave table.
+		std::array<VkDescriptorSet, 2> spectrumSets = { m_DescriptorSets[0], m_DescriptorSets[1] };
+		std::array<uint32_t, 2> spectrumOffsets = { uniformOffset, uniformOffset };
+		spectrumPipeline.Bind(commandBuffer);
+		vkCmdBindDescriptorSets(
+			commandBuffer,
+			VK_PIPELINE_BIND_POINT_COMPUTE,
+			m_ComputePipelineLayout,
+			0,
+			static_cast<uint32_t>(spectrumSets.size()),
+			spectrumSets.data(),
+			static_cast<uint32_t>(spectrumOffsets.size()),
+			spectrumOffsets.data());
+		vkCmdDispatch(commandBuffer, m_GroupSize, 1, 1);
+
+		AddComputeToComputeBarriers(commandBuffer, m_OceanHeightMap->GetHtBuffer(), m_OceanHeightMap->GetHt_dmyBuffer());
+
+		// 2-2: Calculate FFT in vertical direction, a row of one plane per workgroup
+		pipeline.Bind(commandBuffer);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_ComputePipelineLayout, 1, 1, &m_DescriptorSets[2], 1, &uniformOffset);
+		vkCmdDispatch(commandBuffer, m_GroupSize, HeightMap::m_OceanPlaneCount, 1);
+
+		AddComputeToComputeBarriers(commandBuffer, m_OceanHeightMap->GetHtBuffer(), m_OceanHeightMap->GetHt_dmyBuffer());
+	}
+
+	bool VulkanRenderer::IsFFTKernelSupported(FFTKernel kernel) const
+	{
+		// a row, twice for the ping-pong of the Stockham passes
+		size_t sharedMemorySize = m_GroupSize * sizeof(glm::vec2) * (kernel == FFTKernel::Stockham ? 2 : 1);
+		return sharedMemorySize <= m_Device.GetPhDevice().GetProperties().limits.maxComputeSharedMemorySize;
+	}
+
+	std::unique_ptr<ComputePipeline> VulkanRenderer::CreateFFTComputePipeline(FFTKernel kernel, bool fusedSpectrum, bool storePhase)
+	{
+		// log2 of the transform size (constant 0), the workgroup size (constant 1),
+		// FUSED_SPECTRUM (constant 2) and STORE_PHASE (constant 3)
+		uint32_t log2Size = 0;
+		while ((1u << log2Size) < m_GroupSize)
+			log2Size++;
+
+		std::array<uint32_t, 4> fftConstants = {
+			log2Size,
+			m_GroupSize / 2,
+			fusedSpectrum ? VK_TRUE : VK_FALSE,
+			storePhase ? VK_TRUE : VK_FALSE };
+		std::array<VkSpecializationMapEntry, 4> fftEntries = { {
+			{ 0, 0, sizeof(uint32_t) },
+			{ 1, sizeof(uint32_t), sizeof(uint32_t) },
+			{ 2, 2 * sizeof(uint32_t), sizeof(VkBool32) },
+			{ 3, 3 * sizeof(uint32_t), sizeof(VkBool32) } } };
+		VkSpecializationInfo fftSpecialization = {
+			static_cast<uint32_t>(fftEntries.size()),
+			fftEntries.data(),
+			sizeof(fftConstants),
+			fftConstants.data() };
+
+		return std::make_unique<ComputePipeline>(
+			m_Device,
+			kernel == FFTKernel::Stockham ? "Assets/Shaders/FFTStockham.spv" : "Assets/Shaders/FFT.spv",
+			m_ComputePipelineLayout,
+			m_PipelineCache,
+			&fftSpecialization);
+	}
+
+	bool VulkanRenderer::SetFFTKernel(FFTKernel kernel)
+	{
+		if (kernel == m_FFTKernel)
+			return true;
+
+		if (!IsFFTKernelSupported(kernel))
+		{
+			VOE_CORE_WARN("The Stockham FFT of a row doesn't fit into the shared memory of this device");
+			return false;
+		}
+
+		// the compute command buffers may still be executing
+		vkDeviceWaitIdle(m_Device.GetVkDevice());
+
+		m_FFTSpectrumComputePipeline = CreateFFTComputePipeline(kernel, true);
+		m_FFTComputePipeline = CreateFFTComputePipeline(kernel, false);
+		m_FFTKernel = kernel;
+		BuildComputeCommandBuffer();
+		return true;
+	}
+
+	std::vector<VulkanRenderer::FFTKernelTiming> VulkanRenderer::BenchmarkFFTKernels(uint32_t iterations)
 	{
-		if (m_SpecializedComputeQueue) 
+		auto device = m_Device.GetVkDevice();
+		const VkPhysicalDevice physicalDevice = m_Device.GetPhDevice().GetVkPhysicalDevice();
+
+		uint32_t queueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+		std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+		uint32_t timestampBits = queueFamilies[m_Device.GetComputeQueueFamily()].timestampValidBits;
+		if (timestampBits == 0 || iterations == 0)
+		{
+			VOE_CORE_WARN("FFT kernel benchmark: the compute queue doesn't support timestamps");
+			return {};
+		}
+		uint64_t timestampMask = timestampBits >= 64 ? ~0ull : (1ull << timestampBits) - 1;
+		double nanosecondsPerTick = m_Device.GetPhDevice().GetProperties().limits.timestampPeriod;
+
+		// the benchmark overwrites the FFT buffers, nothing of the chain may be in flight
+		vkDeviceWaitIdle(device);
+
+		VkQueryPoolCreateInfo queryPoolInfo = {};
+		queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		queryPoolInfo.queryCount = 2 * iterations;
+		VkQueryPool queryPool;
+		VOE_CHECK_RESULT(vkCreateQueryPool(device, &queryPoolInfo, nullptr, &queryPool));
+
+		std::vector<FFTKernelTiming> results;
+		std::vector<uint64_t> timestamps(2 * iterations);
+
+		VOE_CORE_INFO("FFT kernel benchmark ({0} x {0}, {1} planes, {2} steps)", m_GroupSize, HeightMap::m_OceanPlaneCount, iterations);
+
+		for (FFTKernel kernel : { FFTKernel::CooleyTukey, FFTKernel::Stockham })
 		{
+			const char* kernelName = kernel == FFTKernel::Stockham ? "Stockham" : "Cooley-Tukey";
+			if (!IsFFTKernelSupported(kernel))
+			{
+				VOE_CORE_INFO("  {0:<12} doesn't fit into shared memory", kernelName);
+				continue;
+			}
+
+			// the spectrum is evaluated from h0 every step, without advancing the phases of the simulation
+			std::unique_ptr<ComputePipeline> spectrumPipeline = CreateFFTComputePipeline(kernel, true, false);
+			std::unique_ptr<ComputePipeline> pipeline = CreateFFTComputePipeline(kernel, false);
+			VkCommandBuffer commandBuffer = m_Device.CreateCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY, m_ComputeCommandPool, true);
+			vkCmdResetQueryPool(commandBuffer, queryPool, 0, 2 * iterations);
+
+			for (uint32_t i = 0; i < iterations; i++)
+			{
+				vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, 2 * i);
+				RecordFFTDispatches(commandBuffer, *spectrumPipeline, *pipeline, 0);
+				vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, 2 * i + 1);
+			}
+
+			m_Device.FlushCommandBuffer(commandBuffer, m_Device.GetComputeQueue(), m_ComputeCommandPool, true);
+			VOE_CHECK_RESULT(vkGetQueryPoolResults(
+				device,
+				queryPool,
+				0,
+				2 * iterations,
+				timestamps.size() * sizeof(uint64_t),
+				timestamps.data(),
+				sizeof(uint64_t),
+				VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT));
+
+			uint64_t ticks = 0;
+			for (uint32_t i = 0; i < iterations; i++)
+			{
+				ticks += (timestamps[2 * i + 1] - timestamps[2 * i]) & timestampMask;
+			}
+
+			FFTKernelTiming result;
+			result.Kernel = kernel;
+			result.MicrosecondsPerStep = ticks * nanosecondsPerTick * 1e-3 / iterations;
+			result.Speedup = results.empty() ? 1.0 : results[0].MicrosecondsPerStep / result.MicrosecondsPerStep;
+			results.push_back(result);
+
+			VOE_CORE_INFO("  {0:<12} {1:>10.2f} us per step  {2:>8.2f} us per 2D FFT  x{3:.2f}",
+				kernelName, result.MicrosecondsPerStep, result.MicrosecondsPerStep / HeightMap::m_OceanPlaneCount, result.Speedup);
+		}
+
+		vkDestroyQueryPool(device, queryPool, nullptr);
+		return results;
+	}
+
+	void VulkanRenderer::BuildHistoryCopyCommandBuffers()
+	{
+		VkCommandBufferBeginInfo cmdBufInfo = {};
+		cmdBufInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		cmdBufInfo.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+
+		VkBuffer htBuffer = m_OceanHeightMap->GetHtBuffer();
+		VkImage normalImage = m_OceanHeightMap->GetOceanNormalImage();
+		VkDeviceSize slotSize = m_OceanHeightMap->GetHistorySlotSize();
+		VkDeviceSize normalOffset = m_OceanHeightMap->GetHistoryNormalOffset();
+
+		for (uint32_t slot = 0; slot < m_HistoryCopyCommandBuffers.size(); slot++)
+		{
+			VkCommandBuffer commandBuffer = m_HistoryCopyCommandBuffers[slot];
+			VOE_CHECK_RESULT(vkBeginCommandBuffer(commandBuffer, &cmdBufInfo));
+
+			// the FFT output and the normal map of the compute chain submitted just before
 			VkBufferMemoryBarrier bufferBarrier = {};
 			bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-			bufferBarrier.srcAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
-			bufferBarrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-			bufferBarrier.srcQueueFamilyIndex = m_Device.GetGraphicsQueueFamily();
-			bufferBarrier.dstQueueFamilyIndex = m_Device.GetComputeQueueFamily();
+			bufferBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			bufferBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+			bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			bufferBarrier.buffer = htBuffer;
 			bufferBarrier.size = VK_WHOLE_SIZE;
 
-			std::vector<VkBufferMemoryBarrier> bufferBarriers;
-			bufferBarrier.buffer = m_OceanHeightMap->GetHtBuffer(index);
-			bufferBarriers.push_back(bufferBarrier);
+			VkImageMemoryBarrier imageBarrier = {};
+			imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			imageBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			imageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+			imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			imageBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+			imageBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+			imageBarrier.image = normalImage;
+			imageBarrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
 
 			vkCmdPipelineBarrier(
 				commandBuffer,
-				VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
 				VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+				VK_PIPELINE_STAGE_TRANSFER_BIT,
 				VK_FLAGS_NONE,
-				0, 
-				nullptr,
-				static_cast<uint32_t>(bufferBarriers.size()),
-				bufferBarriers.data(),
-				0,
-				nullptr);
+				0, nullptr,
+				1, &bufferBarrier,
+				1, &imageBarrier);
+
+			// planes 0 and 1 (H_y, (Dx, Dz)) are the first two planes of HtBuffers
+			VkBufferCopy bufferCopy = {};
+			bufferCopy.srcOffset = 0;
+			bufferCopy.dstOffset = slotSize * slot;
+			bufferCopy.size = normalOffset;
+			vkCmdCopyBuffer(commandBuffer, htBuffer, m_OceanHeightMap->GetHistoryBuffer(), 1, &bufferCopy);
+
+			VkBufferImageCopy imageCopy = {};
+			imageCopy.bufferOffset = slotSize * slot + normalOffset;
+			imageCopy.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+			imageCopy.imageExtent = { m_GroupSize, m_GroupSize, 1 };
+			vkCmdCopyImageToBuffer(commandBuffer, normalImage, VK_IMAGE_LAYOUT_GENERAL, m_OceanHeightMap->GetHistoryBuffer(), 1, &imageCopy);
+
+			VOE_CHECK_RESULT(vkEndCommandBuffer(commandBuffer));
+		}
+	}
+
+	void VulkanRenderer::SetOceanPlayback(std::shared_ptr<const OceanLoop> loop)
+	{
+		// uploads in flight may still read the staging buffer
+		vkDeviceWaitIdle(m_Device.GetVkDevice());
+
+		bool playing = loop != nullptr;
+		m_OceanHeightMap->SetPlayback(std::move(loop));
+
+		if (playing)
+		{
+			BuildPlaybackUploadCommandBuffers();
+		}
+	}
+
+	void VulkanRenderer::BuildPlaybackUploadCommandBuffers()
+	{
+		VkCommandBufferBeginInfo cmdBufInfo = {};
+		cmdBufInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		cmdBufInfo.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+
+		VkDeviceSize slotSize = m_OceanHeightMap->GetHistorySlotSize();
+		VkDeviceSize stagingSlotSize = m_OceanHeightMap->GetPlaybackSlotSize();
+
+		for (uint32_t slot = 0; slot < m_PlaybackUploadCommandBuffers.size(); slot++)
+		{
+			VkCommandBuffer commandBuffer = m_PlaybackUploadCommandBuffers[slot];
+			VOE_CHECK_RESULT(vkBeginCommandBuffer(commandBuffer, &cmdBufInfo));
+
+			// host writes to the coherent staging buffer are visible to the submit that follows them
+			VkBufferCopy bufferCopy = {};
+			bufferCopy.srcOffset = stagingSlotSize * slot;
+			bufferCopy.dstOffset = slotSize * slot;
+			bufferCopy.size = slotSize;
+			vkCmdCopyBuffer(commandBuffer, m_OceanHeightMap->GetPlaybackStagingBuffer(), m_OceanHeightMap->GetHistoryBuffer(), 1, &bufferCopy);
+
+			// The foam of the frame replaces the one the previous upload copied into OceanBubbleImage.
+			// The fragment shader reads of the graphics queue are waited for by the compute semaphore at
+			// the transfer stage, the image is shared concurrently so no ownership transfer is needed.
+			VkImageMemoryBarrier imageBarrier = {};
+			imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			imageBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			imageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			imageBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+			imageBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+			imageBarrier.image = m_OceanHeightMap->GetOceanBubbleImage();
+			imageBarrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+			vkCmdPipelineBarrier(
+				commandBuffer,
+				VK_PIPELINE_STAGE_TRANSFER_BIT,
+				VK_PIPELINE_STAGE_TRANSFER_BIT,
+				VK_FLAGS_NONE,
+				0, nullptr,
+				0, nullptr,
+				1, &imageBarrier);
+
+			VkBufferImageCopy imageCopy = {};
+			imageCopy.bufferOffset = stagingSlotSize * slot + slotSize;
+			imageCopy.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+			imageCopy.imageExtent = { m_GroupSize, m_GroupSize, 1 };
+			vkCmdCopyBufferToImage(commandBuffer, m_OceanHeightMap->GetPlaybackStagingBuffer(), m_OceanHeightMap->GetOceanBubbleImage(), VK_IMAGE_LAYOUT_GENERAL, 1, &imageCopy);
+
+			VOE_CHECK_RESULT(vkEndCommandBuffer(commandBuffer));
 		}
 	}
 
@@ -485,44 +758,15 @@ namespace voe {
 			nullptr);
 	}
 
-	void VulkanRenderer::AddComputeToGraphicsBarriers(VkCommandBuffer commandBuffer, uint32_t index)
-	{
-		if (m_SpecializedComputeQueue) 
-		{
-			VkBufferMemoryBarrier bufferBarrier = {};
-			bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-			bufferBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-			bufferBarrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
-			bufferBarrier.srcQueueFamilyIndex = m_Device.GetComputeQueueFamily();
-			bufferBarrier.dstQueueFamilyIndex = m_Device.GetGraphicsQueueFamily();
-			bufferBarrier.size = VK_WHOLE_SIZE;
-
-			std::vector<VkBufferMemoryBarrier> bufferBarriers;
-			bufferBarrier.buffer = m_OceanHeightMap->GetHtBuffer(index);
-			bufferBarriers.push_back(bufferBarrier);
-
-			vkCmdPipelineBarrier(
-				commandBuffer,
-				VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-				VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
-				VK_FLAGS_NONE,
-				0,
-				nullptr,
-				static_cast<uint32_t>(bufferBarriers.size()),
-				bufferBarriers.data(),
-				0,
-				nullptr);
-		}
-	}
-
 	void VulkanRenderer::CreatePipelineLayout()
 	{
 		DescriptorBuilder::Begin(m_DescriptorLayoutCache, m_DescriptorAllocator)
-			.BindBuffer(0, m_OceanHeightMap->GetHtBufferDscInfo(), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT)
-			.BindBuffer(1, m_OceanHeightMap->GetUniformBufferDscInfo(), VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT)
+			.BindBuffer(0, m_OceanHeightMap->GetHistoryBufferDscInfo(), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT)
+			.BindBuffer(1, m_OceanHeightMap->GetUniformBufferDscInfo(), VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_SHADER_STAGE_VERTEX_BIT)
 			.BindBuffer(2, m_GlobalUboDscInfo, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT)
 			.BindImage(3, m_OceanHeightMap->GetOceanNormalTextureDscInfo(), VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT)
 			.BindImage(4, m_OceanHeightMap->GetOceanBubbleTextureDscInfo(), VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_FRAGMENT_BIT)
+			.BindBuffer(5, m_OceanHeightMap->GetInterpolationBufferDscInfo(), VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_SHADER_STAGE_VERTEX_BIT)
 			.Build(m_GraphicsDescriptorSet, m_GraphicsDescriptorSetLayout);
 
 		VkPushConstantRange pushConstantRange = {};
@@ -9,6 +9,7 @@ namespace voe {
     class DescriptorLayoutCache;
     class DescriptorAllocator;
     class HeightMap;
+    class OceanLoop;
     class FrameInfo;
 
     class VOE_API VulkanRenderer
@@ -20,8 +21,31 @@ namespace voe {
             VkSemaphore Complete{ 0L };
         };
 
+        // the whole transform of a row runs in one FFT.comp workgroup of gridSize / 2 invocations
+        static constexpr uint32_t DefaultGridSize = 256;
+        static constexpr uint32_t MinGridSize = 64;
+        static constexpr uint32_t MaxGridSize = 1024;
+
+        // FFT.comp (decimation in frequency, bit reversed gather at the end) or FFTStockham.comp
+        // (autosort, twice the shared memory). Both write the same output.
+        enum class FFTKernel
+        {
+            CooleyTukey,
+            Stockham
+        };
+
+        struct FFTKernelTiming
+        {
+            FFTKernel Kernel;
+            // the spectrum and both FFT directions of every HeightMap plane, as dispatched in one step
+            double MicrosecondsPerStep;
+            // time of CooleyTukey / time of Kernel
+            double Speedup;
+        };
+
     public:
-        VulkanRenderer(Device& device, VkRenderPass renderPass);
+        // gridSize is the number of cells per side of the ocean, a power of two from MinGridSize to MaxGridSize.
+        VulkanRenderer(Device& device, VkRenderPass renderPass, uint32_t gridSize = DefaultGridSize);
         ~VulkanRenderer();
         VulkanRenderer(const VulkanRenderer&) = delete;
         VulkanRenderer& operator=(const VulkanRenderer&) = delete;
@@ -39,6 +63,23 @@ namespace voe {
 
         const uint32_t GetGridSize() { return m_GroupSize; }
         const uint32_t GetOceanSize() { return m_GroupSize * 5 / 2; }
+        HeightMap& GetOceanHeightMap() { return *m_OceanHeightMap; }
+        VkCommandBuffer GetHistoryCopyCommandBuffer(uint32_t slot) { return m_HistoryCopyCommandBuffers[slot]; }
+        VkCommandBuffer GetPlaybackUploadCommandBuffer(uint32_t slot) { return m_PlaybackUploadCommandBuffers[slot]; }
+
+        // Shows a baked OceanLoop instead of simulating, nullptr resumes the compute chain.
+        // Waits for the device to be idle.
+        void SetOceanPlayback(std::shared_ptr<const OceanLoop> loop);
+
+        // Rebuilds the compute chain with another FFT kernel. Waits for the device to be idle.
+        // Returns false (and logs) if the kernel doesn't fit into the shared memory of the device.
+        bool SetFFTKernel(FFTKernel kernel);
+        FFTKernel GetFFTKernel() const { return m_FFTKernel; }
+
+        // Times the FFT dispatches of iterations steps with every kernel that fits the device using
+        // timestamps on the compute queue, and logs a table. Waits for the device to be idle.
+        // Returns nothing if the compute queue doesn't support timestamps.
+        std::vector<FFTKernelTiming> BenchmarkFFTKernels(uint32_t iterations = 64);
 
     private:
         void InitOceanHeightMap();
@@ -49,28 +90,44 @@ namespace voe {
         void SetupFFTOceanComputePipelines();
         void SetupImageTransitionCommand();
 
-        void AddGraphicsToComputeBarriers(VkCommandBuffer commandBuffer, uint32_t index);
+        bool IsFFTKernelSupported(FFTKernel kernel) const;
+        // fusedSpectrum: the horizontal pass, which evaluates the spectrum of its row itself (spectrum.glsl).
+        // storePhase = false keeps the phases of TimeStepMode::Incremental where they are.
+        std::unique_ptr<ComputePipeline> CreateFFTComputePipeline(FFTKernel kernel, bool fusedSpectrum, bool storePhase = true);
+        // the spectrum and both FFT directions of every plane, the result ends up in HtBuffers
+        // index selects the ComputeUBO instance of the frame
+        void RecordFFTDispatches(VkCommandBuffer commandBuffer, ComputePipeline& spectrumPipeline, ComputePipeline& pipeline, uint32_t index);
+
         void AddComputeToComputeBarriers(VkCommandBuffer commandBuffer, VkBuffer InputBuffer, VkBuffer OutputBuffer);
-        void AddComputeToGraphicsBarriers(VkCommandBuffer commandBuffer, uint32_t index);
 
         void CreatePipelineLayout();
         void CreatePipeline(VkRenderPass renderPass);
         void CreatePipelineCache();
 
         void BuildComputeCommandBuffer();
+        // copies a finished step into one slot of the HeightMap history buffer
+        void BuildHistoryCopyCommandBuffers();
+        // copies one slot of the HeightMap playback staging buffer into the same history slot
+        void BuildPlaybackUploadCommandBuffers();
         void BuildImageTransitionCommand();
 
         Device& m_Device;
         bool m_SpecializedComputeQueue = false;
 
-        // 512->256
-        const uint32_t m_GroupSize = 256;
+        // cells per side of the ocean grid, passed to the compute shaders as specialization constants
+        const uint32_t m_GroupSize;
+        // workgroup width of oceanNormal.comp, a row takes m_GroupSize / m_RowGroupSize groups
+        uint32_t m_RowGroupSize = 0;
+        FFTKernel m_FFTKernel = FFTKernel::CooleyTukey;
+        // compute chain dispatches per second, 0 = every frame
+        const float m_OceanFixedStepRate = 30.0f;
 
         // ocean params
         std::unique_ptr<HeightMap> m_OceanHeightMap;
 
         // pipelines
-        std::unique_ptr<ComputePipeline> m_ComputePipeline;
+        // horizontal FFT pass with the spectrum, vertical FFT pass
+        std::unique_ptr<ComputePipeline> m_FFTSpectrumComputePipeline;
         std::unique_ptr<ComputePipeline> m_FFTComputePipeline;
         std::unique_ptr<ComputePipeline> m_ComputeNormalPipeline;
         std::unique_ptr<GraphicsPipeline> m_GraphicsPipeline;
@@ -98,6 +155,9 @@ namespace voe {
         // maybe the following variables should be moved to a Device class ?
         VkCommandPool m_ComputeCommandPool;
         std::array<VkCommandBuffer, 2> m_ComputeCommandBuffers;
+        // one per HeightMap::m_HistorySlotCount
+        std::array<VkCommandBuffer, 3> m_HistoryCopyCommandBuffers;
+        std::array<VkCommandBuffer, 3> m_PlaybackUploadCommandBuffers;
 
         // Command buffer for image transitions
         VkCommandPool m_ImageTransitionCommandPool;
@@ -10,6 +10,13 @@
 #include "Renderer/CameraController.h"
 #include "Renderer/Buffer.h"
 #include "Renderer/FrameInfo.h"
+#include "Renderer/HeightMap/HeightMap.h"
+#include "Renderer/HeightMap/OceanSimulationThread.h"
+#include "Renderer/HeightMap/OceanHeightQuery.h"
+#include "Renderer/HeightMap/OceanBuoyancy.h"
+#include "Renderer/HeightMap/OceanHeightPyramid.h"
+#include "Renderer/HeightMap/OceanSharedRing.h"
+#include "Renderer/HeightMap/OceanRecorder.h"
 
 namespace voe {
 
@@ -27,6 +34,7 @@ namespace voe {
 		m_VulkanBase = std::make_unique<VulkanBase>(m_Window);
 		//LoadGameObjects();
 		CreateOceanFFTObjects();
+		CreateOceanSimulation();
 	}
 
 	Application::~Application()
@@ -43,6 +51,12 @@ namespace voe {
 		viewerObject.m_Transform.Rotation = { -0.66f , 2.33f, 0.0f };
 		CameraController cameraController{};
 
+		if (m_EnableOceanSharedRing)
+		{
+			OpenOceanPublisher();
+		}
+		m_OceanSimulation->Start();
+
 		while (m_Running)
 		{
 			auto newTime = std::chrono::high_resolution_clock::now();
@@ -67,10 +81,49 @@ namespace voe {
 			{
 				int frameIndex = m_VulkanBase->GetFrameIndex();
 				FrameInfo frameInfo{ frameIndex, frameTime, commandBuffer, m_Camera };
+				// never waits for the simulation thread
+				frameInfo.OceanState = m_OceanSimulation->AcquireLatest();
+
+				if (frameInfo.OceanState)
+				{
+					// built on the simulation thread, only valid while the snapshot is
+					m_OceanHeightQuery = frameInfo.OceanState->HeightQuery.get();
+					m_OceanHeightPyramid = frameInfo.OceanState->HeightPyramid.get();
+				}
+
+				if (frameInfo.OceanState && frameInfo.OceanState->StepIndex != m_OceanRecordedStep)
+				{
+					// drops the step rather than waiting if the disk falls behind
+					if (m_OceanRecorder->IsRecording())
+					{
+						m_OceanRecorder->Submit(
+							frameInfo.OceanState->StepIndex,
+							frameInfo.OceanState->Time,
+							frameInfo.OceanState->Ht.data(),
+							frameInfo.OceanState->NormalMap.data());
+					}
+					m_OceanRecordedStep = frameInfo.OceanState->StepIndex;
+				}
+
+				// fixed ticks, frameTime is clamped above so a stall runs a bounded number of them
+				float buoyancyTick = 1.0f / m_BuoyancyTickRate;
+				m_BuoyancyAccumulator += frameTime;
+				while (m_BuoyancyAccumulator >= buoyancyTick)
+				{
+					m_OceanBuoyancy->Step(*m_OceanHeightQuery, buoyancyTick);
+					m_BuoyancyAccumulator -= buoyancyTick;
+				}
 
 				// renderer update and start imgui new frame
 				m_VulkanBase->GetRenderer().OnUpdate(frameTime, frameInfo);
 
+				// the CPU ocean steps to the time of every GPU step, a playback loop doesn't advance it
+				HeightMap& heightMap = m_VulkanBase->GetRenderer().GetOceanHeightMap();
+				if (heightMap.IsStepPending() && !heightMap.IsPlaying())
+				{
+					m_OceanSimulation->SubmitStepTime(heightMap.GetUBO().deltaT);
+				}
+
 				if(m_EnableImgui)
 				m_VulkanBase->GetImguiRenderer().OnUpdate(frameTime, frameInfo, m_Window->GetExtent());
 
@@ -121,6 +174,52 @@ namespace voe {
 		m_GameObjects.push_back(std::move(ocean));
 	}
 
+	void Application::CreateOceanSimulation()
+	{
+		uint32_t gridSize = m_VulkanBase->GetRenderer().GetGridSize();
+		const HeightMap& heightMap = m_VulkanBase->GetRenderer().GetOceanHeightMap();
+		float animRate = heightMap.GetAnimRate();
+		// the step of the GPU ocean, so that its times follow on without restarting the phases
+		float stepRate = heightMap.GetFixedStepRate() > 0.0f ? heightMap.GetFixedStepRate() : m_OceanStepRate;
+
+		// leave the other half of the cores to the main thread and the driver
+		uint32_t threadCount = std::max(1u, std::thread::hardware_concurrency() / 2);
+
+		m_OceanSimulation = std::make_unique<OceanSimulationThread>(
+			gridSize, OceanSpectrumParams{}, stepRate, animRate, threadCount);
+		m_OceanSimulation->FollowSubmittedTimes();
+
+		// built with every step on the simulation thread, empty until the first one
+		m_OceanSimulation->EnableSurfaceQueries(
+			static_cast<float>(m_VulkanBase->GetRenderer().GetOceanSize()),
+			m_VulkanBase->GetRenderer().GetOceanHeightMap().GetUBO().lamda,
+			threadCount);
+		m_EmptyOceanHeightQuery = std::make_unique<OceanHeightQuery>(1);
+		m_EmptyOceanHeightPyramid = std::make_unique<OceanHeightPyramid>(1);
+		m_OceanHeightQuery = m_EmptyOceanHeightQuery.get();
+		m_OceanHeightPyramid = m_EmptyOceanHeightPyramid.get();
+		m_OceanRecorder = std::make_unique<OceanRecorder>();
+		m_OceanBuoyancy = std::make_unique<OceanBuoyancy>(BuoyancyParams{}, threadCount);
+	}
+
+	void Application::OpenOceanPublisher()
+	{
+		// nothing to publish to if another instance already owns the ring
+		m_OceanPublisher = std::make_unique<OceanSharedPublisher>();
+		if (m_OceanPublisher->Open(
+			OceanSharedRing::DefaultName,
+			m_VulkanBase->GetRenderer().GetGridSize(),
+			static_cast<float>(m_VulkanBase->GetRenderer().GetOceanSize()),
+			m_VulkanBase->GetRenderer().GetOceanHeightMap().GetUBO().lamda))
+		{
+			OceanSharedPublisher* publisher = m_OceanPublisher.get();
+			m_OceanSimulation->SetStepCallback([publisher](const OceanSimulatorCPU& simulator, float time)
+			{
+				publisher->Publish(time, simulator.GetHtBuffer().data(), simulator.GetNormalMap().data());
+			});
+		}
+	}
+
 	void Application::OnEvent(Event& e)
 	{
 		EventDispatcher dispatcher(e);
@@ -149,6 +248,7 @@ namespace voe {
 	bool Application::OnWindowClose(WindowCloseEvent& e)
 	{
 		vkDeviceWaitIdle(m_VulkanBase->GetDevice()->GetVkDevice());
+		m_OceanSimulation->Stop();
 		m_Running = false;
 		return true;
 	}
@@ -12,6 +12,12 @@
 namespace voe {
 
 	class Camera;
+	class OceanSimulationThread;
+	class OceanHeightQuery;
+	class OceanBuoyancy;
+	class OceanHeightPyramid;
+	class OceanSharedPublisher;
+	class OceanRecorder;
 
 	class VOE_API Application
 	{
@@ -26,12 +32,26 @@ namespace voe {
 
 		static Application& Get() { return *s_Instance; }
 		Window& GetWindow() { return *m_Window; }
+		// water heights of the latest CPU ocean step, updated at the start of every frame and only
+		// valid until the next one
+		OceanHeightQuery& GetOceanHeightQuery() { return *m_OceanHeightQuery; }
+		// floating bodies, stepped at m_BuoyancyTickRate before the frame is rendered
+		OceanBuoyancy& GetOceanBuoyancy() { return *m_OceanBuoyancy; }
+		// ray casts against the same step as GetOceanHeightQuery
+		OceanHeightPyramid& GetOceanHeightPyramid() { return *m_OceanHeightPyramid; }
+		// every CPU ocean step the frame loop sees is submitted while it records
+		OceanRecorder& GetOceanRecorder() { return *m_OceanRecorder; }
+		// Publishes every CPU ocean step to OceanSharedRing::DefaultName for other processes.
+		// Off by default, call before Run. The command line switch --ocean-shared-ring turns it on.
+		void EnableOceanSharedRing() { m_EnableOceanSharedRing = true; }
 
 	private:
 		bool OnWindowClose(WindowCloseEvent& e);
 		static Application* s_Instance;
 		void LoadGameObjects();
 		void CreateOceanFFTObjects();
+		void CreateOceanSimulation();
+		void OpenOceanPublisher();
 
 		Camera m_Camera {};
 		std::shared_ptr<Window> m_Window;
@@ -41,6 +61,25 @@ namespace voe {
 		std::unique_ptr<VulkanBase> m_VulkanBase;
 		std::vector<GameObject> m_GameObjects;
 
+		// every CPU ocean step for other processes, written from the simulation thread which is stopped first
+		std::unique_ptr<OceanSharedPublisher> m_OceanPublisher;
+		bool m_EnableOceanSharedRing = false;
+		// CPU copy of the ocean for physics and queries, stepped on its own thread
+		std::unique_ptr<OceanSimulationThread> m_OceanSimulation;
+		// step rate of m_OceanSimulation when the GPU ocean steps every frame
+		const float m_OceanStepRate = 60.0f;
+		// those of the latest snapshot of m_OceanSimulation, or the empty ones before the first step
+		OceanHeightQuery* m_OceanHeightQuery = nullptr;
+		OceanHeightPyramid* m_OceanHeightPyramid = nullptr;
+		std::unique_ptr<OceanHeightQuery> m_EmptyOceanHeightQuery;
+		std::unique_ptr<OceanHeightPyramid> m_EmptyOceanHeightPyramid;
+		// step of the last snapshot submitted to m_OceanRecorder
+		uint64_t m_OceanRecordedStep = 0;
+		std::unique_ptr<OceanRecorder> m_OceanRecorder;
+		std::unique_ptr<OceanBuoyancy> m_OceanBuoyancy;
+		const float m_BuoyancyTickRate = 60.0f;
+		float m_BuoyancyAccumulator = 0.0f;
+
 #ifdef VOE_DEBUG
 		const bool m_EnableImgui = true;
 #else
@@ -0,0 +1,252 @@
+#include "PreCompileHeader.h"
+#include "BatchedFFT2D.h"
+
+namespace voe
+{
+	namespace
+	{
+		// at least this many tasks per thread and pass, so stealing has something to balance
+		const uint32_t MinChunksPerThread = 4;
+
+		using TransposeFunc = void (*)(const float* src, uint32_t srcStride, float* dst, uint32_t dstStride);
+
+		// dst[c * dstStride + r] = src[r * srcStride + c] for an 8 x 8 tile
+		void TransposeTileScalar(const float* src, uint32_t srcStride, float* dst, uint32_t dstStride)
+		{
+			for (uint32_t c = 0; c < 8; c++)
+			{
+				for (uint32_t r = 0; r < 8; r++)
+				{
+					dst[c * dstStride + r] = src[r * srcStride + c];
+				}
+			}
+		}
+
+		void TransposeTileSse(const float* src, uint32_t srcStride, float* dst, uint32_t dstStride)
+		{
+			for (uint32_t r = 0; r < 8; r += 4)
+			{
+				for (uint32_t c = 0; c < 8; c += 4)
+				{
+					__m128 v0 = _mm_loadu_ps(src + (r + 0) * srcStride + c);
+					__m128 v1 = _mm_loadu_ps(src + (r + 1) * srcStride + c);
+					__m128 v2 = _mm_loadu_ps(src + (r + 2) * srcStride + c);
+					__m128 v3 = _mm_loadu_ps(src + (r + 3) * srcStride + c);
+
+					_MM_TRANSPOSE4_PS(v0, v1, v2, v3);
+
+					_mm_storeu_ps(dst + (c + 0) * dstStride + r, v0);
+					_mm_storeu_ps(dst + (c + 1) * dstStride + r, v1);
+					_mm_storeu_ps(dst + (c + 2) * dstStride + r, v2);
+					_mm_storeu_ps(dst + (c + 3) * dstStride + r, v3);
+				}
+			}
+		}
+
+		void TransposeTileAvx(const float* src, uint32_t srcStride, float* dst, uint32_t dstStride)
+		{
+			__m256 r[8];
+			for (uint32_t i = 0; i < 8; i++)
+			{
+				r[i] = _mm256_loadu_ps(src + i * srcStride);
+			}
+
+			// interleave pairs of rows, then pairs of pairs, then swap the 128-bit halves
+			__m256 t[8];
+			for (uint32_t i = 0; i < 8; i += 2)
+			{
+				t[i] = _mm256_unpacklo_ps(r[i], r[i + 1]);
+				t[i + 1] = _mm256_unpackhi_ps(r[i], r[i + 1]);
+			}
+
+			__m256 s[8];
+			for (uint32_t i = 0; i < 8; i += 4)
+			{
+				s[i + 0] = _mm256_shuffle_ps(t[i + 0], t[i + 2], _MM_SHUFFLE(1, 0, 1, 0));
+				s[i + 1] = _mm256_shuffle_ps(t[i + 0], t[i + 2], _MM_SHUFFLE(3, 2, 3, 2));
+				s[i + 2] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(1, 0, 1, 0));
+				s[i + 3] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(3, 2, 3, 2));
+			}
+
+			for (uint32_t i = 0; i < 4; i++)
+			{
+				_mm256_storeu_ps(dst + i * dstStride, _mm256_permute2f128_ps(s[i], s[i + 4], 0x20));
+				_mm256_storeu_ps(dst + (i + 4) * dstStride, _mm256_permute2f128_ps(s[i], s[i + 4], 0x31));
+			}
+		}
+
+		TransposeFunc GetTransposeFunc(simd::SimdLevel level)
+		{
+			switch (level)
+			{
+			case simd::SimdLevel::AVX2:
+				return TransposeTileAvx;
+			case simd::SimdLevel::SSE:
+				return TransposeTileSse;
+			default:
+				return TransposeTileScalar;
+			}
+		}
+	}
+
+	static_assert(BatchedFFT2D::TileSize == 8, "the transpose kernels work on 8 x 8 tiles");
+
+	BatchedFFT2D::BatchedFFT2D(uint32_t size, uint32_t planeCount, FFTDirection direction, ThreadPool& threadPool, bool shiftOutput)
+		: m_Size(size), m_PlaneCount(planeCount), m_ShiftOutput(shiftOutput), m_ThreadPool(threadPool)
+	{
+		if (planeCount == 0 || planeCount > MaxPlaneCount)
+		{
+			throw std::runtime_error("BatchedFFT2D: plane count must be in [1, MaxPlaneCount]");
+		}
+
+		m_Plan = FFTPlan::Get(size, direction);
+
+		const uint32_t elementCount = size * size;
+		const uint32_t threadCount = threadPool.GetThreadCount();
+
+		m_Transposed.resize(2 * elementCount * planeCount);
+		m_TransposedPlanes.resize(planeCount);
+		for (uint32_t p = 0; p < planeCount; p++)
+		{
+			m_TransposedPlanes[p] = { &m_Transposed[2 * p * elementCount], &m_Transposed[(2 * p + 1) * elementCount] };
+		}
+
+		m_RowStride = 2 * size * TileSize;
+		m_ScratchStride = m_Plan->GetSplitScratchSize(TileSize);
+		m_Rows.resize(m_RowStride * threadCount);
+		m_Scratch.resize(m_ScratchStride * threadCount);
+
+		// A chunk reads its rows and writes the same number of columns, 16 bytes per element
+		// and row. Size it to the L2 cache, but keep enough chunks for every thread.
+		uint32_t chunkRows = ThreadPool::GetL2CacheSize() / (16 * size);
+		uint32_t balancedRows = size * planeCount / (MinChunksPerThread * threadCount);
+		chunkRows = std::min(chunkRows, balancedRows) / TileSize * TileSize;
+
+		m_ChunkRows = std::min(std::max(chunkRows, TileSize), size);
+		m_ChunkCount = (size + m_ChunkRows - 1) / m_ChunkRows;
+	}
+
+	void BatchedFFT2D::Execute(const SplitPlane* planes)
+	{
+		for (uint32_t p = 0; p < m_PlaneCount; p++)
+		{
+			m_RowsStarted[p].store(0, std::memory_order_relaxed);
+			m_RowsDone[p].store(0, std::memory_order_relaxed);
+		}
+
+		// the row tasks of all planes, then the column tasks of all planes
+		const uint32_t taskCount = 2 * m_PlaneCount * m_ChunkCount;
+		m_ThreadPool.ParallelFor(taskCount, 1, [this, planes](uint32_t begin, uint32_t end, uint32_t threadIndex)
+		{
+			for (uint32_t task = begin; task < end; task++)
+			{
+				RunTask(planes, task, threadIndex);
+			}
+		});
+	}
+
+	void BatchedFFT2D::RunTask(const SplitPlane* planes, uint32_t task, uint32_t threadIndex)
+	{
+		const uint32_t passTaskCount = m_PlaneCount * m_ChunkCount;
+		const uint32_t plane = task % passTaskCount / m_ChunkCount;
+
+		if (task < passTaskCount)
+		{
+			RunRowChunk(planes, plane, threadIndex);
+			return;
+		}
+
+		// A column chunk needs every row of its plane. Rows nobody has started yet are run here,
+		// so a thread never waits for work that is queued behind it, only for chunks in flight.
+		// This is also what lets the columns of one plane overlap the rows of the next.
+		while (RunRowChunk(planes, plane, threadIndex))
+		{
+		}
+		while (m_RowsDone[plane].load(std::memory_order_acquire) < m_ChunkCount)
+		{
+			std::this_thread::yield();
+		}
+
+		uint32_t rowBegin = task % m_ChunkCount * m_ChunkRows;
+		uint32_t rowEnd = std::min(rowBegin + m_ChunkRows, m_Size);
+		TransformRows(m_TransposedPlanes[plane], planes[plane], rowBegin, rowEnd, threadIndex);
+	}
+
+	bool BatchedFFT2D::RunRowChunk(const SplitPlane* planes, uint32_t plane, uint32_t threadIndex)
+	{
+		uint32_t chunk = m_RowsStarted[plane].fetch_add(1, std::memory_order_relaxed);
+		if (chunk >= m_ChunkCount)
+		{
+			return false;
+		}
+
+		uint32_t rowBegin = chunk * m_ChunkRows;
+		uint32_t rowEnd = std::min(rowBegin + m_ChunkRows, m_Size);
+		TransformRows(planes[plane], m_TransposedPlanes[plane], rowBegin, rowEnd, threadIndex);
+
+		m_RowsDone[plane].fetch_add(1, std::memory_order_release);
+		return true;
+	}
+
+	void BatchedFFT2D::TransformRows(const SplitPlane& src, const SplitPlane& dst, uint32_t rowBegin, uint32_t rowEnd, uint32_t threadIndex)
+	{
+		const uint32_t N = m_Size;
+		const uint32_t shift = m_ShiftOutput ? N / 2 : 0;
+		// whole tiles only while the shift keeps them in one piece
+		const bool tiled = N >= 2 * TileSize;
+		const TransposeFunc transpose = GetTransposeFunc(m_Plan->GetSimdLevel());
+
+		float* rows = &m_Rows[threadIndex * m_RowStride];
+		float* scratch = &m_Scratch[threadIndex * m_ScratchStride];
+
+		std::array<const float*, TileSize> inRe, inIm;
+		std::array<float*, TileSize> outRe, outIm;
+		for (uint32_t r = 0; r < TileSize; r++)
+		{
+			outRe[r] = rows + r * N;
+			outIm[r] = rows + (TileSize + r) * N;
+		}
+
+		for (uint32_t y0 = rowBegin; y0 < rowEnd; y0 += TileSize)
+		{
+			const uint32_t tileRows = std::min(TileSize, rowEnd - y0);
+
+			for (uint32_t r = 0; r < tileRows; r++)
+			{
+				inRe[r] = src.Re + (y0 + r) * N;
+				inIm[r] = src.Im + (y0 + r) * N;
+			}
+
+			m_Plan->ExecuteSplit(tileRows, inRe.data(), inIm.data(), outRe.data(), outIm.data(), scratch);
+
+			// row y0 + r, element x -> row (x + shift) % N, element y0 + r
+			for (uint32_t component = 0; component < 2; component++)
+			{
+				const float* block = rows + component * TileSize * N;
+				float* target = component == 0 ? dst.Re : dst.Im;
+
+				if (tiled && tileRows == TileSize)
+				{
+					for (uint32_t x0 = 0; x0 < N; x0 += TileSize)
+					{
+						transpose(block + x0, N, target + (x0 + shift) % N * N + y0, N);
+					}
+					continue;
+				}
+
+				for (uint32_t r = 0; r < tileRows; r++)
+				{
+					for (uint32_t x = 0; x < N; x++)
+					{
+						target[(x + shift) % N * N + y0 + r] = block[r * N + x];
+					}
+				}
+			}
+		}
+
+		if (m_Plan->GetSimdLevel() == simd::SimdLevel::AVX2)
+		{
+			_mm256_zeroupper();
+		}
+	}
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "VOceanEngine/FFTPlan.h"
+#include "VOceanEngine/ThreadPool.h"
+
+#include <array>
+
+namespace voe
+{
+	// One complex size x size plane stored as separate re and im arrays, row major.
+	struct SplitPlane
+	{
+		float* Re;
+		float* Im;
+	};
+
+	// 2D FFT of several planes at once. TileSize rows of a plane go through FFTPlan::ExecuteSplit
+	// together, so the twiddles and the loop overhead are shared between them. Each pass writes
+	// its rows out with TileSize x TileSize in-register transposes, so both passes read and write
+	// whole cache lines and the column pass runs over contiguous rows as well.
+	// The row and column passes of every plane are split into chunks sized to the L2 cache and run
+	// as one work-stealing ThreadPool loop, where the columns of a plane start as soon as its rows
+	// are done, while later planes are still in their row pass.
+	// Nothing is allocated after construction.
+	class VOE_API BatchedFFT2D
+	{
+	public:
+		// upper bound for planeCount
+		static constexpr uint32_t MaxPlaneCount = 8;
+		// rows transformed and transposed together
+		static constexpr uint32_t TileSize = 8;
+
+		// threadPool has to outlive this object.
+		// shiftOutput = true applies fftshift in both transposes (element n is stored at
+		// (n + size / 2) % size per dimension), like the stores of FFT.comp.
+		BatchedFFT2D(uint32_t size, uint32_t planeCount, FFTDirection direction, ThreadPool& threadPool, bool shiftOutput = false);
+		~BatchedFFT2D() = default;
+
+		BatchedFFT2D(const BatchedFFT2D&) = delete;
+		BatchedFFT2D& operator=(const BatchedFFT2D&) = delete;
+
+		// Transforms GetPlaneCount() planes in place.
+		void Execute(const SplitPlane* planes);
+
+		uint32_t GetSize() const { return m_Size; }
+		uint32_t GetPlaneCount() const { return m_PlaneCount; }
+		// rows (of one plane) per task
+		uint32_t GetChunkRows() const { return m_ChunkRows; }
+		bool IsOutputShifted() const { return m_ShiftOutput; }
+
+	private:
+		// task < m_PlaneCount * m_ChunkCount: a row chunk, otherwise column chunk of one plane
+		void RunTask(const SplitPlane* planes, uint32_t task, uint32_t threadIndex);
+		// Runs the next row chunk of plane nobody has started yet. False if there is none.
+		bool RunRowChunk(const SplitPlane* planes, uint32_t plane, uint32_t threadIndex);
+		// 1D FFTs of the rows [rowBegin, rowEnd) of src, written to the same columns of dst.
+		void TransformRows(const SplitPlane& src, const SplitPlane& dst, uint32_t rowBegin, uint32_t rowEnd, uint32_t threadIndex);
+
+		uint32_t m_Size;
+		uint32_t m_PlaneCount;
+		bool m_ShiftOutput;
+		std::shared_ptr<const FFTPlan> m_Plan;
+		ThreadPool& m_ThreadPool;
+
+		// the planes between the two passes
+		std::vector<float> m_Transposed;
+		std::vector<SplitPlane> m_TransposedPlanes;
+		// per thread: TileSize transformed rows and the ExecuteSplit scratch
+		std::vector<float> m_Rows;
+		std::vector<float> m_Scratch;
+		uint32_t m_RowStride;
+		uint32_t m_ScratchStride;
+
+		uint32_t m_ChunkRows;
+		uint32_t m_ChunkCount;
+		// row chunks per plane claimed / finished in the current Execute
+		std::array<std::atomic<uint32_t>, MaxPlaneCount> m_RowsStarted;
+		std::array<std::atomic<uint32_t>, MaxPlaneCount> m_RowsDone;
+	};
+}
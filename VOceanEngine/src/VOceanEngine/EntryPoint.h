@@ -2,6 +2,8 @@
 
 #ifdef VOE_PLATFORM_WINDOWS
 
+#include <cstring>
+
 extern voe::Application* voe::CreateApplication();
 
 int main(int argc, char** argv)
@@ -10,6 +12,11 @@ int main(int argc, char** argv)
 	VOE_CORE_WARN("Initialized Log");
 
 	auto app = voe::CreateApplication();
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--ocean-shared-ring") == 0)
+			app->EnableOceanSharedRing();
+	}
 	app->Run();
 	delete app;
 }
@@ -0,0 +1,168 @@
+#include "PreCompileHeader.h"
+#include "FFTBenchmark.h"
+
+namespace voe
+{
+	namespace
+	{
+		using Clock = std::chrono::high_resolution_clock;
+
+		// Runs func until at least minSeconds have passed and returns seconds per call.
+		template<typename Func>
+		double TimeCall(Func&& func, double minSeconds)
+		{
+			uint32_t iterations = 1;
+			for (;;)
+			{
+				auto begin = Clock::now();
+				for (uint32_t i = 0; i < iterations; i++)
+				{
+					func();
+				}
+				double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+
+				if (seconds >= minSeconds)
+				{
+					return seconds / iterations;
+				}
+				iterations *= 2;
+			}
+		}
+	}
+
+	std::vector<FFTBenchmarkResult> RunFFTBenchmark(uint32_t minSize, uint32_t maxSize)
+	{
+		std::vector<simd::SimdLevel> levels = { simd::SimdLevel::Scalar, simd::SimdLevel::SSE };
+		if (simd::GetSimdLevel() == simd::SimdLevel::AVX2)
+		{
+			levels.push_back(simd::SimdLevel::AVX2);
+		}
+
+		std::vector<FFTBenchmarkResult> results;
+		std::mt19937 rng(1234);
+		std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+		VOE_CORE_INFO("FFT benchmark (5 N log2 N flops per transform)");
+
+		for (uint32_t size = std::max(minSize, FFTPlan::MinSize); size <= std::min(maxSize, FFTPlan::MaxSize); size *= 2)
+		{
+			std::vector<glm::vec2> input(size);
+			std::vector<glm::vec2> output(size);
+			std::vector<glm::vec2> reference(size);
+			std::vector<glm::vec2> scratch(size);
+
+			for (auto& value : input)
+			{
+				value = glm::vec2(dist(rng), dist(rng));
+			}
+
+			double referenceSeconds = TimeCall([&]() { FFTPlan::ExecuteReference(input.data(), reference.data(), size, FFTDirection::Forward); }, 0.05);
+
+			double referenceMax = 0.0;
+			for (const auto& value : reference)
+			{
+				referenceMax = std::max(referenceMax, static_cast<double>(glm::length(value)));
+			}
+
+			for (auto level : levels)
+			{
+				FFTPlan plan(size, FFTDirection::Forward, 1, level);
+				plan.Execute(input.data(), output.data(), scratch.data());
+
+				double maxError = 0.0;
+				for (uint32_t i = 0; i < size; i++)
+				{
+					maxError = std::max(maxError, static_cast<double>(glm::length(output[i] - reference[i])));
+				}
+
+				double seconds = TimeCall([&]() { plan.Execute(input.data(), output.data(), scratch.data()); }, 0.05);
+
+				FFTBenchmarkResult result;
+				result.Size = size;
+				result.Level = level;
+				result.MicrosecondsPerTransform = seconds * 1e6;
+				result.GFlops = plan.GetFlopCount() / seconds * 1e-9;
+				result.ReferenceGFlops = plan.GetFlopCount() / referenceSeconds * 1e-9;
+				result.MaxError = maxError / referenceMax;
+				results.push_back(result);
+
+				const char* levelName = level == simd::SimdLevel::AVX2 ? "AVX2" : level == simd::SimdLevel::SSE ? "SSE" : "Scalar";
+				VOE_CORE_INFO("  N = {0:>5} {1:<6} {2:>10.3f} us  {3:>7.2f} GFLOP/s  (reference {4:.3f} GFLOP/s, x{5:.0f})  error {6:.2e}",
+					size, levelName, result.MicrosecondsPerTransform, result.GFlops, result.ReferenceGFlops,
+					result.GFlops / result.ReferenceGFlops, result.MaxError);
+			}
+		}
+
+		return results;
+	}
+
+	std::vector<FFT2DScalingResult> RunFFT2DScalingBenchmark(uint32_t minSize, uint32_t maxSize, uint32_t maxThreads, uint32_t planeCount, bool pinThreads)
+	{
+		if (maxThreads == 0)
+		{
+			maxThreads = std::max(1u, std::thread::hardware_concurrency());
+		}
+
+		std::vector<uint32_t> threadCounts;
+		for (uint32_t threads = 1; threads < maxThreads; threads *= 2)
+		{
+			threadCounts.push_back(threads);
+		}
+		threadCounts.push_back(maxThreads);
+
+		std::vector<FFT2DScalingResult> results;
+		std::mt19937 rng(1234);
+		std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+		VOE_CORE_INFO("2D FFT strong scaling ({0} planes, L2 {1} KiB)", planeCount, ThreadPool::GetL2CacheSize() / 1024);
+
+		for (uint32_t size = std::max(minSize, FFTPlan::MinSize); size <= std::min(maxSize, FFTPlan::MaxSize); size *= 2)
+		{
+			std::vector<float> input(2 * size * size * planeCount);
+			for (auto& value : input)
+			{
+				value = dist(rng);
+			}
+			std::vector<float> data(input.size());
+
+			std::vector<SplitPlane> planes(planeCount);
+			for (uint32_t p = 0; p < planeCount; p++)
+			{
+				planes[p] = { &data[2 * p * size * size], &data[(2 * p + 1) * size * size] };
+			}
+
+			double singleThreadSeconds = 0.0;
+
+			for (uint32_t threads : threadCounts)
+			{
+				ThreadPool pool(threads, pinThreads);
+				BatchedFFT2D fft(size, planeCount, FFTDirection::Inverse, pool);
+
+				// The transform is unnormalized and in place, so every call starts from the same input.
+				// Otherwise the data grows by N^2 per call and the timing soon runs on inf and NaN.
+				auto restore = [&]() { std::memcpy(data.data(), input.data(), data.size() * sizeof(float)); };
+				restore();
+				fft.Execute(planes.data());
+				double copySeconds = TimeCall(restore, 0.05);
+				double seconds = TimeCall([&]() { restore(); fft.Execute(planes.data()); }, 0.2) - copySeconds;
+				if (threads == 1)
+				{
+					singleThreadSeconds = seconds;
+				}
+
+				FFT2DScalingResult result;
+				result.Size = size;
+				result.ThreadCount = threads;
+				result.MillisecondsPerTransform = seconds * 1e3;
+				result.Speedup = singleThreadSeconds / seconds;
+				result.Efficiency = result.Speedup / threads;
+				results.push_back(result);
+
+				VOE_CORE_INFO("  N = {0:>5} threads {1:>3} {2:>10.3f} ms  speedup {3:>6.2f}  efficiency {4:>4.0f}%  ({5} rows per chunk)",
+					size, threads, result.MillisecondsPerTransform, result.Speedup, result.Efficiency * 100.0, fft.GetChunkRows());
+			}
+		}
+
+		return results;
+	}
+}
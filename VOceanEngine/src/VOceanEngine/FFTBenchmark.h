@@ -0,0 +1,44 @@
+#pragma once
+
+#include "VOceanEngine/BatchedFFT2D.h"
+#include "VOceanEngine/FFTPlan.h"
+
+namespace voe
+{
+	struct FFTBenchmarkResult
+	{
+		uint32_t Size;
+		simd::SimdLevel Level;
+		double MicrosecondsPerTransform;
+		double GFlops;
+		double ReferenceGFlops;
+		// max |fft - reference| / max |reference|
+		double MaxError;
+	};
+
+	// Times FFTPlan against FFTPlan::ExecuteReference for every power of two in
+	// [minSize, maxSize] and every SIMD level the CPU supports, and logs a table.
+	// GFLOP/s use the 5 N log2(N) convention for both.
+	VOE_API std::vector<FFTBenchmarkResult> RunFFTBenchmark(uint32_t minSize = 64, uint32_t maxSize = 4096);
+
+	struct FFT2DScalingResult
+	{
+		uint32_t Size;
+		uint32_t ThreadCount;
+		double MillisecondsPerTransform;
+		// time with one thread / time with ThreadCount threads
+		double Speedup;
+		// Speedup / ThreadCount
+		double Efficiency;
+	};
+
+	// Strong scaling of BatchedFFT2D: the same planeCount planes of every power of two size in
+	// [minSize, maxSize], transformed with 1, 2, 4, ... maxThreads threads, and logs a table.
+	// maxThreads = 0 uses every hardware thread.
+	VOE_API std::vector<FFT2DScalingResult> RunFFT2DScalingBenchmark(
+		uint32_t minSize = 256,
+		uint32_t maxSize = 2048,
+		uint32_t maxThreads = 0,
+		uint32_t planeCount = 3,
+		bool pinThreads = false);
+}
@@ -0,0 +1,693 @@
+#include "PreCompileHeader.h"
+#include "FFTPlan.h"
+
+namespace voe
+{
+	std::mutex FFTPlan::s_CacheMutex;
+	std::map<std::tuple<uint32_t, FFTDirection, uint32_t>, std::shared_ptr<const FFTPlan>> FFTPlan::s_Cache;
+
+	namespace
+	{
+		// ------------------------------------------------------------------
+		// Complex vectors, (re, im) interleaved
+		// ------------------------------------------------------------------
+		struct ComplexSse
+		{
+			static constexpr uint32_t Width = 2;
+
+			__m128 v;
+
+			static ComplexSse Load(const glm::vec2* p) { return { _mm_loadu_ps(&p->x) }; }
+			static ComplexSse Load(const float* p) { return { _mm_loadu_ps(p) }; }
+			void Store(glm::vec2* p) const { _mm_storeu_ps(&p->x, v); }
+
+			// (re, im) -> (im, re)
+			ComplexSse Swap() const { return { _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)) }; }
+			ComplexSse FlipSign(uint32_t lane) const
+			{
+				__m128 mask = lane == 0 ? _mm_setr_ps(-0.0f, 0.0f, -0.0f, 0.0f) : _mm_setr_ps(0.0f, -0.0f, 0.0f, -0.0f);
+				return { _mm_xor_ps(v, mask) };
+			}
+		};
+
+		inline ComplexSse operator+(ComplexSse a, ComplexSse b) { return { _mm_add_ps(a.v, b.v) }; }
+		inline ComplexSse operator-(ComplexSse a, ComplexSse b) { return { _mm_sub_ps(a.v, b.v) }; }
+		inline ComplexSse operator*(ComplexSse a, ComplexSse b) { return { _mm_mul_ps(a.v, b.v) }; }
+
+		// y[4 (j + q) + r] = v[r][q] for the 2 complex lanes q
+		inline void StoreTransposed(glm::vec2* y, const ComplexSse* v)
+		{
+			_mm_storeu_ps(&y[0].x, _mm_movelh_ps(v[0].v, v[1].v));
+			_mm_storeu_ps(&y[2].x, _mm_movelh_ps(v[2].v, v[3].v));
+			_mm_storeu_ps(&y[4].x, _mm_movehl_ps(v[1].v, v[0].v));
+			_mm_storeu_ps(&y[6].x, _mm_movehl_ps(v[3].v, v[2].v));
+		}
+
+		struct ComplexAvx
+		{
+			static constexpr uint32_t Width = 4;
+
+			__m256 v;
+
+			static ComplexAvx Load(const glm::vec2* p) { return { _mm256_loadu_ps(&p->x) }; }
+			static ComplexAvx Load(const float* p) { return { _mm256_loadu_ps(p) }; }
+			void Store(glm::vec2* p) const { _mm256_storeu_ps(&p->x, v); }
+
+			ComplexAvx Swap() const { return { _mm256_permute_ps(v, _MM_SHUFFLE(2, 3, 0, 1)) }; }
+			ComplexAvx FlipSign(uint32_t lane) const
+			{
+				__m256 mask = lane == 0
+					? _mm256_setr_ps(-0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f)
+					: _mm256_setr_ps(0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f);
+				return { _mm256_xor_ps(v, mask) };
+			}
+		};
+
+		inline ComplexAvx operator+(ComplexAvx a, ComplexAvx b) { return { _mm256_add_ps(a.v, b.v) }; }
+		inline ComplexAvx operator-(ComplexAvx a, ComplexAvx b) { return { _mm256_sub_ps(a.v, b.v) }; }
+		inline ComplexAvx operator*(ComplexAvx a, ComplexAvx b) { return { _mm256_mul_ps(a.v, b.v) }; }
+
+		// 4x4 transpose of complex numbers (treated as 64-bit lanes)
+		inline void StoreTransposed(glm::vec2* y, const ComplexAvx* v)
+		{
+			__m256d t0 = _mm256_unpacklo_pd(_mm256_castps_pd(v[0].v), _mm256_castps_pd(v[1].v));
+			__m256d t1 = _mm256_unpackhi_pd(_mm256_castps_pd(v[0].v), _mm256_castps_pd(v[1].v));
+			__m256d t2 = _mm256_unpacklo_pd(_mm256_castps_pd(v[2].v), _mm256_castps_pd(v[3].v));
+			__m256d t3 = _mm256_unpackhi_pd(_mm256_castps_pd(v[2].v), _mm256_castps_pd(v[3].v));
+
+			_mm256_storeu_pd(reinterpret_cast<double*>(&y[0]), _mm256_permute2f128_pd(t0, t2, 0x20));
+			_mm256_storeu_pd(reinterpret_cast<double*>(&y[4]), _mm256_permute2f128_pd(t1, t3, 0x20));
+			_mm256_storeu_pd(reinterpret_cast<double*>(&y[8]), _mm256_permute2f128_pd(t0, t2, 0x31));
+			_mm256_storeu_pd(reinterpret_cast<double*>(&y[12]), _mm256_permute2f128_pd(t1, t3, 0x31));
+		}
+
+		template<typename V>
+		inline V MultiplyTwiddle(V a, const float* re, const float* im)
+		{
+			return a * V::Load(re) + a.Swap() * V::Load(im);
+		}
+
+		// a * -i (forward) or a * i (inverse)
+		template<typename V, bool Inverse>
+		inline V RotateQuarter(V a)
+		{
+			return Inverse ? a.Swap().FlipSign(0) : a.Swap().FlipSign(1);
+		}
+
+		template<typename V, bool Inverse>
+		inline void Butterfly4(V* v)
+		{
+			V t0 = v[0] + v[2];
+			V t1 = v[0] - v[2];
+			V t2 = v[1] + v[3];
+			V t3 = RotateQuarter<V, Inverse>(v[1] - v[3]);
+
+			v[0] = t0 + t2;
+			v[1] = t1 + t3;
+			v[2] = t0 - t2;
+			v[3] = t1 - t3;
+		}
+
+		// ------------------------------------------------------------------
+		// Stages
+		// ------------------------------------------------------------------
+
+		// First radix-4 stage (Ns = 1): no twiddles, outputs interleaved by 4.
+		template<typename V, bool Inverse>
+		void Radix4FirstStage(const glm::vec2* x, glm::vec2* y, uint32_t n)
+		{
+			const uint32_t quarter = n / 4;
+
+			for (uint32_t j = 0; j < quarter; j += V::Width)
+			{
+				V v[4] = { V::Load(x + j), V::Load(x + j + quarter), V::Load(x + j + 2 * quarter), V::Load(x + j + 3 * quarter) };
+				Butterfly4<V, Inverse>(v);
+				StoreTransposed(y + 4 * j, v);
+			}
+		}
+
+		// Radix-4 stage with Ns >= V::Width, every load and store is unit stride.
+		template<typename V, bool Inverse>
+		void Radix4Stage(const glm::vec2* x, glm::vec2* y, uint32_t n, uint32_t ns, const float* twRe, const float* twIm)
+		{
+			const uint32_t quarter = n / 4;
+
+			for (uint32_t j = 0; j < quarter; j += V::Width)
+			{
+				uint32_t k = j & (ns - 1);
+
+				V v[4] = { V::Load(x + j), V::Load(x + j + quarter), V::Load(x + j + 2 * quarter), V::Load(x + j + 3 * quarter) };
+				for (uint32_t r = 1; r < 4; r++)
+				{
+					uint32_t tw = ((r - 1) * ns + k) * 2;
+					v[r] = MultiplyTwiddle(v[r], twRe + tw, twIm + tw);
+				}
+
+				Butterfly4<V, Inverse>(v);
+
+				glm::vec2* dst = y + (j - k) * 4 + k;
+				v[0].Store(dst);
+				v[1].Store(dst + ns);
+				v[2].Store(dst + 2 * ns);
+				v[3].Store(dst + 3 * ns);
+			}
+		}
+
+		// Radix-2 stage with Ns >= V::Width.
+		template<typename V>
+		void Radix2Stage(const glm::vec2* x, glm::vec2* y, uint32_t n, uint32_t ns, const float* twRe, const float* twIm)
+		{
+			const uint32_t half = n / 2;
+
+			for (uint32_t j = 0; j < half; j += V::Width)
+			{
+				uint32_t k = j & (ns - 1);
+
+				V v0 = V::Load(x + j);
+				V v1 = MultiplyTwiddle(V::Load(x + j + half), twRe + k * 2, twIm + k * 2);
+
+				glm::vec2* dst = y + (j - k) * 2 + k;
+				(v0 + v1).Store(dst);
+				(v0 - v1).Store(dst + ns);
+			}
+		}
+
+		glm::vec2 MultiplyComplex(glm::vec2 a, glm::vec2 b)
+		{
+			return glm::vec2(a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x);
+		}
+
+		// Any stage, one complex number at a time.
+		template<bool Inverse>
+		void ScalarStage(const glm::vec2* x, glm::vec2* y, uint32_t n, uint32_t radix, uint32_t ns, const float* twRe, const float* twIm)
+		{
+			const uint32_t stride = n / radix;
+
+			for (uint32_t j = 0; j < stride; j++)
+			{
+				uint32_t k = j & (ns - 1);
+
+				glm::vec2 v[4];
+				for (uint32_t r = 0; r < radix; r++)
+				{
+					v[r] = x[j + r * stride];
+					if (r > 0 && ns > 1)
+					{
+						uint32_t tw = ((r - 1) * ns + k) * 2;
+						v[r] = MultiplyComplex(v[r], glm::vec2(twRe[tw], twIm[tw + 1]));
+					}
+				}
+
+				glm::vec2* dst = y + (j - k) * radix + k;
+				if (radix == 2)
+				{
+					dst[0] = v[0] + v[1];
+					dst[ns] = v[0] - v[1];
+					continue;
+				}
+
+				glm::vec2 t0 = v[0] + v[2];
+				glm::vec2 t1 = v[0] - v[2];
+				glm::vec2 t2 = v[1] + v[3];
+				glm::vec2 d = v[1] - v[3];
+				glm::vec2 t3 = Inverse ? glm::vec2(-d.y, d.x) : glm::vec2(d.y, -d.x);
+
+				dst[0] = t0 + t2;
+				dst[ns] = t1 + t3;
+				dst[2 * ns] = t0 - t2;
+				dst[3 * ns] = t1 - t3;
+			}
+		}
+
+		template<typename V, bool Inverse>
+		void RunStage(const glm::vec2* x, glm::vec2* y, uint32_t n, uint32_t radix, uint32_t ns, const float* twRe, const float* twIm)
+		{
+			bool vectorizable = (n / radix) % V::Width == 0;
+
+			if (vectorizable && radix == 4 && ns == 1)
+			{
+				Radix4FirstStage<V, Inverse>(x, y, n);
+			}
+			else if (vectorizable && ns >= V::Width)
+			{
+				if (radix == 4)
+				{
+					Radix4Stage<V, Inverse>(x, y, n, ns, twRe, twIm);
+				}
+				else
+				{
+					Radix2Stage<V>(x, y, n, ns, twRe, twIm);
+				}
+			}
+			else
+			{
+				ScalarStage<Inverse>(x, y, n, radix, ns, twRe, twIm);
+			}
+		}
+
+		// ------------------------------------------------------------------
+		// Split (structure of arrays) stages. Each stage processes count arrays in
+		// lockstep, x / y hold count pointers for re and im.
+		// ------------------------------------------------------------------
+		struct SplitArrays
+		{
+			const float* const* Re;
+			const float* const* Im;
+		};
+
+		struct SplitOutput
+		{
+			float* const* Re;
+			float* const* Im;
+		};
+
+		template<typename F, bool Inverse>
+		inline void SplitButterfly4(F* re, F* im)
+		{
+			F t0r = re[0] + re[2], t0i = im[0] + im[2];
+			F t1r = re[0] - re[2], t1i = im[0] - im[2];
+			F t2r = re[1] + re[3], t2i = im[1] + im[3];
+			F dr = re[1] - re[3], di = im[1] - im[3];
+
+			// d * -i = (di, -dr), d * i = (-di, dr)
+			F zero = F::Zero();
+			F t3r = Inverse ? zero - di : di;
+			F t3i = Inverse ? dr : zero - dr;
+
+			re[0] = t0r + t2r; im[0] = t0i + t2i;
+			re[1] = t1r + t3r; im[1] = t1i + t3i;
+			re[2] = t0r - t2r; im[2] = t0i - t2i;
+			re[3] = t1r - t3r; im[3] = t1i - t3i;
+		}
+
+		template<bool Inverse>
+		void SplitRadix4FirstStage(uint32_t count, SplitArrays x, SplitOutput y, uint32_t n)
+		{
+			using F = simd::Float4;
+			const uint32_t quarter = n / 4;
+
+			for (uint32_t j = 0; j < quarter; j += F::Width)
+			{
+				for (uint32_t a = 0; a < count; a++)
+				{
+					F re[4], im[4];
+					for (uint32_t r = 0; r < 4; r++)
+					{
+						re[r] = F::Load(x.Re[a] + j + r * quarter);
+						im[r] = F::Load(x.Im[a] + j + r * quarter);
+					}
+
+					SplitButterfly4<F, Inverse>(re, im);
+
+					// y[4 (j + q) + r] = v[r][q]
+					_MM_TRANSPOSE4_PS(re[0].v, re[1].v, re[2].v, re[3].v);
+					_MM_TRANSPOSE4_PS(im[0].v, im[1].v, im[2].v, im[3].v);
+					for (uint32_t q = 0; q < 4; q++)
+					{
+						re[q].Store(y.Re[a] + 4 * (j + q));
+						im[q].Store(y.Im[a] + 4 * (j + q));
+					}
+				}
+			}
+		}
+
+		template<typename F, bool Inverse>
+		void SplitRadix4Stage(uint32_t count, SplitArrays x, SplitOutput y, uint32_t n, uint32_t ns, const float* twRe, const float* twIm)
+		{
+			const uint32_t quarter = n / 4;
+
+			for (uint32_t j = 0; j < quarter; j += F::Width)
+			{
+				uint32_t k = j & (ns - 1);
+				uint32_t dst = (j - k) * 4 + k;
+
+				F wr[3], wi[3];
+				for (uint32_t r = 0; r < 3; r++)
+				{
+					wr[r] = F::Load(twRe + r * ns + k);
+					wi[r] = F::Load(twIm + r * ns + k);
+				}
+
+				for (uint32_t a = 0; a < count; a++)
+				{
+					F re[4], im[4];
+					re[0] = F::Load(x.Re[a] + j);
+					im[0] = F::Load(x.Im[a] + j);
+					for (uint32_t r = 1; r < 4; r++)
+					{
+						F vr = F::Load(x.Re[a] + j + r * quarter);
+						F vi = F::Load(x.Im[a] + j + r * quarter);
+						re[r] = vr * wr[r - 1] - vi * wi[r - 1];
+						im[r] = vr * wi[r - 1] + vi * wr[r - 1];
+					}
+
+					SplitButterfly4<F, Inverse>(re, im);
+
+					for (uint32_t r = 0; r < 4; r++)
+					{
+						re[r].Store(y.Re[a] + dst + r * ns);
+						im[r].Store(y.Im[a] + dst + r * ns);
+					}
+				}
+			}
+		}
+
+		template<typename F>
+		void SplitRadix2Stage(uint32_t count, SplitArrays x, SplitOutput y, uint32_t n, uint32_t ns, const float* twRe, const float* twIm)
+		{
+			const uint32_t half = n / 2;
+
+			for (uint32_t j = 0; j < half; j += F::Width)
+			{
+				uint32_t k = j & (ns - 1);
+				uint32_t dst = (j - k) * 2 + k;
+
+				F wr = F::Load(twRe + k);
+				F wi = F::Load(twIm + k);
+
+				for (uint32_t a = 0; a < count; a++)
+				{
+					F r0 = F::Load(x.Re[a] + j);
+					F i0 = F::Load(x.Im[a] + j);
+					F vr = F::Load(x.Re[a] + j + half);
+					F vi = F::Load(x.Im[a] + j + half);
+					F r1 = vr * wr - vi * wi;
+					F i1 = vr * wi + vi * wr;
+
+					(r0 + r1).Store(y.Re[a] + dst);
+					(i0 + i1).Store(y.Im[a] + dst);
+					(r0 - r1).Store(y.Re[a] + dst + ns);
+					(i0 - i1).Store(y.Im[a] + dst + ns);
+				}
+			}
+		}
+
+		template<bool Inverse>
+		void SplitScalarStage(uint32_t count, SplitArrays x, SplitOutput y, uint32_t n, uint32_t radix, uint32_t ns, const float* twRe, const float* twIm)
+		{
+			const uint32_t stride = n / radix;
+
+			for (uint32_t a = 0; a < count; a++)
+			{
+				for (uint32_t j = 0; j < stride; j++)
+				{
+					uint32_t k = j & (ns - 1);
+
+					glm::vec2 v[4];
+					for (uint32_t r = 0; r < radix; r++)
+					{
+						v[r] = glm::vec2(x.Re[a][j + r * stride], x.Im[a][j + r * stride]);
+						if (r > 0 && ns > 1)
+						{
+							v[r] = MultiplyComplex(v[r], glm::vec2(twRe[(r - 1) * ns + k], twIm[(r - 1) * ns + k]));
+						}
+					}
+
+					uint32_t dst = (j - k) * radix + k;
+					glm::vec2 out[4];
+					if (radix == 2)
+					{
+						out[0] = v[0] + v[1];
+						out[1] = v[0] - v[1];
+					}
+					else
+					{
+						glm::vec2 t0 = v[0] + v[2];
+						glm::vec2 t1 = v[0] - v[2];
+						glm::vec2 t2 = v[1] + v[3];
+						glm::vec2 d = v[1] - v[3];
+						glm::vec2 t3 = Inverse ? glm::vec2(-d.y, d.x) : glm::vec2(d.y, -d.x);
+
+						out[0] = t0 + t2;
+						out[1] = t1 + t3;
+						out[2] = t0 - t2;
+						out[3] = t1 - t3;
+					}
+
+					for (uint32_t r = 0; r < radix; r++)
+					{
+						y.Re[a][dst + r * ns] = out[r].x;
+						y.Im[a][dst + r * ns] = out[r].y;
+					}
+				}
+			}
+		}
+
+		// Picks the widest kernel whose lanes stay unit stride for this stage.
+		template<bool Inverse>
+		void RunSplitStage(simd::SimdLevel level, uint32_t count, SplitArrays x, SplitOutput y, uint32_t n, uint32_t radix, uint32_t ns, const float* twRe, const float* twIm)
+		{
+			uint32_t stride = n / radix;
+
+			if (level == simd::SimdLevel::AVX2 && ns >= simd::Float8::Width && stride % simd::Float8::Width == 0)
+			{
+				radix == 4 ? SplitRadix4Stage<simd::Float8, Inverse>(count, x, y, n, ns, twRe, twIm)
+					: SplitRadix2Stage<simd::Float8>(count, x, y, n, ns, twRe, twIm);
+			}
+			else if (level != simd::SimdLevel::Scalar && stride % simd::Float4::Width == 0 && radix == 4 && ns == 1)
+			{
+				SplitRadix4FirstStage<Inverse>(count, x, y, n);
+			}
+			else if (level != simd::SimdLevel::Scalar && ns >= simd::Float4::Width && stride % simd::Float4::Width == 0)
+			{
+				radix == 4 ? SplitRadix4Stage<simd::Float4, Inverse>(count, x, y, n, ns, twRe, twIm)
+					: SplitRadix2Stage<simd::Float4>(count, x, y, n, ns, twRe, twIm);
+			}
+			else
+			{
+				SplitScalarStage<Inverse>(count, x, y, n, radix, ns, twRe, twIm);
+			}
+		}
+
+		thread_local std::vector<glm::vec2> t_Scratch;
+	}
+
+	FFTPlan::FFTPlan(uint32_t size, FFTDirection direction, uint32_t batch, simd::SimdLevel level)
+		: m_Size(size), m_Batch(batch), m_Direction(direction), m_Level(level)
+	{
+		if (size < MinSize || size > MaxSize || (size & (size - 1)) != 0)
+		{
+			throw std::runtime_error("FFTPlan: size must be a power of two between 2 and 65536");
+		}
+
+		uint32_t log2Size = 0;
+		while ((1u << log2Size) < size)
+		{
+			log2Size++;
+		}
+
+		// radix-4 stages first, the radix-2 stage (odd log2) last where Ns = N / 2 keeps it unit stride
+		uint32_t ns = 1;
+		for (uint32_t i = 0; i < log2Size / 2; i++)
+		{
+			m_Stages.push_back({ 4, ns, 0 });
+			ns *= 4;
+		}
+		if (log2Size % 2 == 1)
+		{
+			m_Stages.push_back({ 2, ns, 0 });
+		}
+
+		const double sign = direction == FFTDirection::Forward ? -1.0 : 1.0;
+
+		for (auto& stage : m_Stages)
+		{
+			stage.TwiddleOffset = static_cast<uint32_t>(m_TwiddleRe.size());
+
+			for (uint32_t r = 1; r < stage.Radix; r++)
+			{
+				for (uint32_t k = 0; k < stage.Ns; k++)
+				{
+					double angle = sign * 2.0 * glm::pi<double>() * r * k / (stage.Ns * stage.Radix);
+					float wr = static_cast<float>(std::cos(angle));
+					float wi = static_cast<float>(std::sin(angle));
+
+					m_TwiddleRe.push_back(wr);
+					m_TwiddleRe.push_back(wr);
+					m_TwiddleIm.push_back(-wi);
+					m_TwiddleIm.push_back(wi);
+
+					m_SplitTwiddleRe.push_back(wr);
+					m_SplitTwiddleIm.push_back(wi);
+				}
+			}
+		}
+	}
+
+	std::shared_ptr<const FFTPlan> FFTPlan::Get(uint32_t size, FFTDirection direction, uint32_t batch)
+	{
+		std::lock_guard<std::mutex> lock(s_CacheMutex);
+
+		auto& plan = s_Cache[std::make_tuple(size, direction, batch)];
+		if (!plan)
+		{
+			plan = std::make_shared<FFTPlan>(size, direction, batch);
+		}
+		return plan;
+	}
+
+	void FFTPlan::ClearCache()
+	{
+		std::lock_guard<std::mutex> lock(s_CacheMutex);
+		s_Cache.clear();
+	}
+
+	double FFTPlan::GetFlopCount() const
+	{
+		return 5.0 * m_Size * std::log2(static_cast<double>(m_Size)) * m_Batch;
+	}
+
+	void FFTPlan::Execute(const glm::vec2* in, glm::vec2* out) const
+	{
+		if (t_Scratch.size() < m_Size)
+		{
+			t_Scratch.resize(m_Size);
+		}
+		Execute(in, out, t_Scratch.data());
+	}
+
+	void FFTPlan::Execute(const glm::vec2* in, glm::vec2* out, glm::vec2* scratch) const
+	{
+		for (uint32_t b = 0; b < m_Batch; b++)
+		{
+			ExecuteOne(in + b * m_Size, out + b * m_Size, scratch);
+		}
+
+		if (m_Level == simd::SimdLevel::AVX2)
+		{
+			_mm256_zeroupper();
+		}
+	}
+
+	void FFTPlan::ExecuteOne(const glm::vec2* in, glm::vec2* out, glm::vec2* scratch) const
+	{
+		const uint32_t stageCount = static_cast<uint32_t>(m_Stages.size());
+
+		// Ping-pong between out and scratch so that the last stage writes to out.
+		// An in-place transform with an odd stage count starts from a copy in scratch.
+		const glm::vec2* src = in;
+		if (in == out && stageCount % 2 == 1)
+		{
+			std::copy(in, in + m_Size, scratch);
+			src = scratch;
+		}
+
+		glm::vec2* dst = stageCount % 2 == 1 ? out : scratch;
+
+		for (const auto& stage : m_Stages)
+		{
+			const float* twRe = m_TwiddleRe.data() + stage.TwiddleOffset;
+			const float* twIm = m_TwiddleIm.data() + stage.TwiddleOffset;
+			bool inverse = m_Direction == FFTDirection::Inverse;
+
+			switch (m_Level)
+			{
+			case simd::SimdLevel::AVX2:
+				inverse ? RunStage<ComplexAvx, true>(src, dst, m_Size, stage.Radix, stage.Ns, twRe, twIm)
+					: RunStage<ComplexAvx, false>(src, dst, m_Size, stage.Radix, stage.Ns, twRe, twIm);
+				break;
+			case simd::SimdLevel::SSE:
+				inverse ? RunStage<ComplexSse, true>(src, dst, m_Size, stage.Radix, stage.Ns, twRe, twIm)
+					: RunStage<ComplexSse, false>(src, dst, m_Size, stage.Radix, stage.Ns, twRe, twIm);
+				break;
+			default:
+				inverse ? ScalarStage<true>(src, dst, m_Size, stage.Radix, stage.Ns, twRe, twIm)
+					: ScalarStage<false>(src, dst, m_Size, stage.Radix, stage.Ns, twRe, twIm);
+				break;
+			}
+
+			src = dst;
+			dst = dst == out ? scratch : out;
+		}
+	}
+
+	void FFTPlan::ExecuteSplit(
+		uint32_t count,
+		const float* const* inRe,
+		const float* const* inIm,
+		float* const* outRe,
+		float* const* outIm,
+		float* scratch) const
+	{
+		for (uint32_t first = 0; first < count; first += MaxSplitCount)
+		{
+			uint32_t groupCount = std::min(count - first, MaxSplitCount);
+			ExecuteSplitGroup(groupCount, inRe + first, inIm + first, outRe + first, outIm + first, scratch);
+		}
+
+		if (m_Level == simd::SimdLevel::AVX2)
+		{
+			_mm256_zeroupper();
+		}
+	}
+
+	void FFTPlan::ExecuteSplitGroup(
+		uint32_t count,
+		const float* const* inRe,
+		const float* const* inIm,
+		float* const* outRe,
+		float* const* outIm,
+		float* scratch) const
+	{
+		const uint32_t stageCount = static_cast<uint32_t>(m_Stages.size());
+
+		std::array<float*, MaxSplitCount> scratchRe;
+		std::array<float*, MaxSplitCount> scratchIm;
+		for (uint32_t a = 0; a < count; a++)
+		{
+			scratchRe[a] = scratch + 2 * a * m_Size;
+			scratchIm[a] = scratch + (2 * a + 1) * m_Size;
+		}
+
+		// same ping-pong as ExecuteOne
+		SplitArrays src = { inRe, inIm };
+		if (stageCount % 2 == 1 && (inRe[0] == outRe[0] || inIm[0] == outIm[0]))
+		{
+			for (uint32_t a = 0; a < count; a++)
+			{
+				std::copy(inRe[a], inRe[a] + m_Size, scratchRe[a]);
+				std::copy(inIm[a], inIm[a] + m_Size, scratchIm[a]);
+			}
+			src = { scratchRe.data(), scratchIm.data() };
+		}
+
+		SplitOutput out = { outRe, outIm };
+		SplitOutput temp = { scratchRe.data(), scratchIm.data() };
+		bool toOut = stageCount % 2 == 1;
+
+		for (const auto& stage : m_Stages)
+		{
+			const float* twRe = m_SplitTwiddleRe.data() + stage.TwiddleOffset / 2;
+			const float* twIm = m_SplitTwiddleIm.data() + stage.TwiddleOffset / 2;
+			SplitOutput dst = toOut ? out : temp;
+			bool inverse = m_Direction == FFTDirection::Inverse;
+
+			inverse ? RunSplitStage<true>(m_Level, count, src, dst, m_Size, stage.Radix, stage.Ns, twRe, twIm)
+				: RunSplitStage<false>(m_Level, count, src, dst, m_Size, stage.Radix, stage.Ns, twRe, twIm);
+
+			src = { dst.Re, dst.Im };
+			toOut = !toOut;
+		}
+	}
+
+	void FFTPlan::ExecuteReference(const glm::vec2* in, glm::vec2* out, uint32_t size, FFTDirection direction)
+	{
+		const double sign = direction == FFTDirection::Forward ? -1.0 : 1.0;
+
+		for (uint32_t k = 0; k < size; k++)
+		{
+			double re = 0.0;
+			double im = 0.0;
+			for (uint32_t n = 0; n < size; n++)
+			{
+				// reduce n k mod N first to keep the angle accurate for large sizes
+				double angle = sign * 2.0 * glm::pi<double>() * ((static_cast<uint64_t>(n) * k) % size) / size;
+				double c = std::cos(angle);
+				double s = std::sin(angle);
+				re += in[n].x * c - in[n].y * s;
+				im += in[n].x * s + in[n].y * c;
+			}
+			out[k] = glm::vec2(static_cast<float>(re), static_cast<float>(im));
+		}
+	}
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "VOceanEngine/SimdMath.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+
+namespace voe
+{
+	enum class FFTDirection : uint32_t
+	{
+		// X[k] = sum x[n] e^(-2 pi i nk / N)
+		Forward = 0,
+		// x[n] = sum X[k] e^(+2 pi i nk / N), not normalized
+		Inverse
+	};
+
+	// Complex FFT of power-of-two size over (re, im) pairs.
+	// Radix-4 Stockham stages (plus one radix-2 stage for odd log2 sizes) with precomputed
+	// twiddle tables, vectorized for SSE (2 complex numbers per register) and AVX2 (4).
+	// The output is in natural order, so no bit reversal pass is needed.
+	// A plan is immutable after construction and can be shared between threads.
+	class VOE_API FFTPlan
+	{
+	public:
+		static constexpr uint32_t MinSize = 2;
+		static constexpr uint32_t MaxSize = 1 << 16;
+		// arrays transformed in lockstep by one ExecuteSplit pass
+		static constexpr uint32_t MaxSplitCount = 8;
+
+		// batch transforms of size elements are stored back to back.
+		FFTPlan(uint32_t size, FFTDirection direction, uint32_t batch = 1, simd::SimdLevel level = simd::GetSimdLevel());
+		~FFTPlan() = default;
+
+		FFTPlan(const FFTPlan&) = delete;
+		FFTPlan& operator=(const FFTPlan&) = delete;
+
+		// Returns the shared plan for (size, direction, batch), creating it on first use.
+		static std::shared_ptr<const FFTPlan> Get(uint32_t size, FFTDirection direction, uint32_t batch = 1);
+		static void ClearCache();
+
+		// Transforms all batches. in == out is allowed, other overlaps are not.
+		// scratch has to hold GetScratchSize() elements.
+		void Execute(const glm::vec2* in, glm::vec2* out, glm::vec2* scratch) const;
+		// Uses a scratch buffer owned by the calling thread.
+		void Execute(const glm::vec2* in, glm::vec2* out) const;
+
+		// Transforms count arrays stored as separate re / im arrays (structure of arrays) in lockstep,
+		// so every twiddle load is shared by all of them. Ignores the batch of the plan.
+		// out may alias in. scratch has to hold GetSplitScratchSize(count) floats.
+		void ExecuteSplit(
+			uint32_t count,
+			const float* const* inRe,
+			const float* const* inIm,
+			float* const* outRe,
+			float* const* outIm,
+			float* scratch) const;
+
+		// Direct O(N^2) DFT in double precision, used to validate and benchmark the plans.
+		static void ExecuteReference(const glm::vec2* in, glm::vec2* out, uint32_t size, FFTDirection direction);
+
+		uint32_t GetSize() const { return m_Size; }
+		uint32_t GetBatch() const { return m_Batch; }
+		FFTDirection GetDirection() const { return m_Direction; }
+		simd::SimdLevel GetSimdLevel() const { return m_Level; }
+		uint32_t GetScratchSize() const { return m_Size; }
+		uint32_t GetSplitScratchSize(uint32_t count) const { return 2 * m_Size * std::min(count, MaxSplitCount); }
+
+		// 5 N log2(N) per transform, the usual convention for FFT GFLOP/s figures.
+		double GetFlopCount() const;
+
+	private:
+		struct Stage
+		{
+			uint32_t Radix;
+			// length of the sub-transforms already combined by the previous stages
+			uint32_t Ns;
+			// start of this stage in the twiddle tables
+			uint32_t TwiddleOffset;
+		};
+
+		void ExecuteOne(const glm::vec2* in, glm::vec2* out, glm::vec2* scratch) const;
+		void ExecuteSplitGroup(
+			uint32_t count,
+			const float* const* inRe,
+			const float* const* inIm,
+			float* const* outRe,
+			float* const* outIm,
+			float* scratch) const;
+
+		uint32_t m_Size;
+		uint32_t m_Batch;
+		FFTDirection m_Direction;
+		simd::SimdLevel m_Level;
+
+		std::vector<Stage> m_Stages;
+
+		// w^(r k) of every stage for r = 1 .. Radix - 1 and k = 0 .. Ns - 1, stored per complex
+		// number as (wr, wr) and (-wi, wi) so that a * w = a * re + swap(a) * im.
+		std::vector<float> m_TwiddleRe;
+		std::vector<float> m_TwiddleIm;
+		// the same twiddles once per complex number for the split format
+		std::vector<float> m_SplitTwiddleRe;
+		std::vector<float> m_SplitTwiddleIm;
+
+		static std::mutex s_CacheMutex;
+		static std::map<std::tuple<uint32_t, FFTDirection, uint32_t>, std::shared_ptr<const FFTPlan>> s_Cache;
+	};
+}
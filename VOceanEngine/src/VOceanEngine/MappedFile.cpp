@@ -0,0 +1,280 @@
+#include "PreCompileHeader.h"
+#include "MappedFile.h"
+
+#ifndef VOE_PLATFORM_WINDOWS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace voe
+{
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+#ifdef VOE_PLATFORM_WINDOWS
+	bool MappedFile::Open(const std::string& path, Access access, size_t size)
+	{
+		Close();
+
+		bool write = access == Access::Create;
+
+		m_File = CreateFileA(
+			path.c_str(),
+			write ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+			FILE_SHARE_READ,
+			nullptr,
+			write ? CREATE_ALWAYS : OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL,
+			nullptr);
+
+		if (m_File == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		if (!write)
+		{
+			LARGE_INTEGER fileSize;
+			if (!GetFileSizeEx(m_File, &fileSize))
+			{
+				Close();
+				return false;
+			}
+			size = static_cast<size_t>(fileSize.QuadPart);
+		}
+
+		// empty files can't be mapped
+		if (size == 0)
+		{
+			Close();
+			return false;
+		}
+
+		uint64_t mappingSize = static_cast<uint64_t>(size);
+		m_Mapping = CreateFileMappingA(
+			m_File,
+			nullptr,
+			write ? PAGE_READWRITE : PAGE_READONLY,
+			static_cast<DWORD>(mappingSize >> 32),
+			static_cast<DWORD>(mappingSize),
+			nullptr);
+
+		if (m_Mapping == nullptr)
+		{
+			Close();
+			return false;
+		}
+
+		m_Data = MapViewOfFile(m_Mapping, write ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size);
+		if (m_Data == nullptr)
+		{
+			Close();
+			return false;
+		}
+
+		m_Size = size;
+		return true;
+	}
+
+	bool MappedFile::OpenShared(const std::string& name, Access access, size_t size)
+	{
+		Close();
+
+		bool write = access == Access::Create;
+		std::string objectName = "Local\\" + name;
+
+		if (write)
+		{
+			if (size == 0)
+			{
+				return false;
+			}
+
+			uint64_t mappingSize = static_cast<uint64_t>(size);
+			m_Mapping = CreateFileMappingA(
+				INVALID_HANDLE_VALUE,
+				nullptr,
+				PAGE_READWRITE,
+				static_cast<DWORD>(mappingSize >> 32),
+				static_cast<DWORD>(mappingSize),
+				objectName.c_str());
+
+			// someone else owns the name, its size may not match
+			if (m_Mapping != nullptr && GetLastError() == ERROR_ALREADY_EXISTS)
+			{
+				Close();
+				return false;
+			}
+		}
+		else
+		{
+			m_Mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, objectName.c_str());
+		}
+
+		if (m_Mapping == nullptr)
+		{
+			Close();
+			return false;
+		}
+
+		m_Data = MapViewOfFile(m_Mapping, write ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, write ? size : 0);
+		if (m_Data == nullptr)
+		{
+			Close();
+			return false;
+		}
+
+		if (!write)
+		{
+			// the view covers the whole object, rounded up to pages
+			MEMORY_BASIC_INFORMATION info;
+			if (VirtualQuery(m_Data, &info, sizeof(info)) == 0)
+			{
+				Close();
+				return false;
+			}
+			size = static_cast<size_t>(info.RegionSize);
+		}
+
+		m_Size = size;
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (m_Data != nullptr)
+		{
+			UnmapViewOfFile(m_Data);
+			m_Data = nullptr;
+		}
+
+		if (m_Mapping != nullptr)
+		{
+			CloseHandle(m_Mapping);
+			m_Mapping = nullptr;
+		}
+
+		if (m_File != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(m_File);
+			m_File = INVALID_HANDLE_VALUE;
+		}
+
+		m_Size = 0;
+	}
+
+	bool MappedFile::Flush()
+	{
+		return m_Data != nullptr && FlushViewOfFile(m_Data, 0) && FlushFileBuffers(m_File);
+	}
+#else
+	bool MappedFile::Open(const std::string& path, Access access, size_t size)
+	{
+		Close();
+
+		bool write = access == Access::Create;
+
+		m_File = write ? open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644) : open(path.c_str(), O_RDONLY);
+		if (m_File < 0)
+		{
+			return false;
+		}
+
+		return Map(write, size);
+	}
+
+	bool MappedFile::OpenShared(const std::string& name, Access access, size_t size)
+	{
+		Close();
+
+		bool write = access == Access::Create;
+		std::string objectName = "/" + name;
+
+		m_File = write
+			? shm_open(objectName.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644)
+			: shm_open(objectName.c_str(), O_RDONLY, 0);
+		if (m_File < 0)
+		{
+			return false;
+		}
+
+		if (write)
+		{
+			m_SharedName = objectName;
+		}
+
+		return Map(write, size);
+	}
+
+	bool MappedFile::Map(bool write, size_t size)
+	{
+		if (write)
+		{
+			if (ftruncate(m_File, static_cast<off_t>(size)) != 0)
+			{
+				Close();
+				return false;
+			}
+		}
+		else
+		{
+			struct stat st;
+			if (fstat(m_File, &st) != 0)
+			{
+				Close();
+				return false;
+			}
+			size = static_cast<size_t>(st.st_size);
+		}
+
+		if (size == 0)
+		{
+			Close();
+			return false;
+		}
+
+		void* data = mmap(nullptr, size, write ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, m_File, 0);
+		if (data == MAP_FAILED)
+		{
+			Close();
+			return false;
+		}
+
+		m_Data = data;
+		m_Size = size;
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (m_Data != nullptr)
+		{
+			munmap(m_Data, m_Size);
+			m_Data = nullptr;
+		}
+
+		if (m_File >= 0)
+		{
+			close(m_File);
+			m_File = -1;
+		}
+
+		if (!m_SharedName.empty())
+		{
+			shm_unlink(m_SharedName.c_str());
+			m_SharedName.clear();
+		}
+
+		m_Size = 0;
+	}
+
+	bool MappedFile::Flush()
+	{
+		return m_Data != nullptr && msync(m_Data, m_Size, MS_SYNC) == 0;
+	}
+#endif
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace voe
+{
+	// Memory mapped view of a whole file, or of a named shared memory object (OpenShared).
+	// The mapping is released on destruction.
+	class VOE_API MappedFile
+	{
+	public:
+		enum class Access
+		{
+			// Maps an existing file (shared memory object) for reading.
+			Read = 0,
+			// Creates (or truncates) the file (shared memory object) with the given size and maps it for writing.
+			Create
+		};
+
+		MappedFile() = default;
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		// Returns false (and leaves the object closed) if the file can't be opened or mapped.
+		bool Open(const std::string& path, Access access, size_t size = 0);
+		// Same for shared memory that other processes open by name: a file mapping in the session
+		// namespace on Windows, shm_open("/" + name) elsewhere. The object lives until its creator
+		// closes it, readers keep their mapping after that.
+		bool OpenShared(const std::string& name, Access access, size_t size = 0);
+		void Close();
+
+		// Writes the dirty pages of a writable mapping back to the file.
+		bool Flush();
+
+		bool IsOpen() const { return m_Data != nullptr; }
+		void* GetData() const { return m_Data; }
+		size_t GetSize() const { return m_Size; }
+
+	private:
+		void* m_Data = nullptr;
+		size_t m_Size = 0;
+
+#ifdef VOE_PLATFORM_WINDOWS
+		HANDLE m_File = INVALID_HANDLE_VALUE;
+		HANDLE m_Mapping = nullptr;
+#else
+		bool Map(bool write, size_t size);
+
+		int m_File = -1;
+		// shm_open name of an object this instance created, unlinked on Close
+		std::string m_SharedName;
+#endif
+	};
+}
@@ -0,0 +1,50 @@
+#include "PreCompileHeader.h"
+#include "SimdMath.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace voe
+{
+	namespace simd
+	{
+		static SimdLevel DetectSimdLevel()
+		{
+#ifdef _MSC_VER
+			int info[4] = {};
+			__cpuid(info, 0);
+			int maxLeaf = info[0];
+
+			__cpuid(info, 1);
+			bool osxsave = (info[2] & (1 << 27)) != 0;
+			bool avx = (info[2] & (1 << 28)) != 0;
+
+			bool avx2 = false;
+			if (maxLeaf >= 7)
+			{
+				__cpuidex(info, 7, 0);
+				avx2 = (info[1] & (1 << 5)) != 0;
+			}
+
+			// the OS has to save the YMM registers on context switches
+			bool ymmEnabled = osxsave && ((_xgetbv(0) & 0x6) == 0x6);
+
+			if (avx && avx2 && ymmEnabled)
+			{
+				return SimdLevel::AVX2;
+			}
+			return SimdLevel::SSE;
+#else
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2") ? SimdLevel::AVX2 : SimdLevel::SSE;
+#endif
+		}
+
+		SimdLevel GetSimdLevel()
+		{
+			static const SimdLevel level = DetectSimdLevel();
+			return level;
+		}
+	}
+}
@@ -0,0 +1,300 @@
+#pragma once
+
+#include <immintrin.h>
+#include <cstdint>
+
+// Thin wrappers around SSE2 / AVX2 registers so that vectorized kernels can be
+// written once and instantiated for 4 or 8 lanes. The transcendental functions
+// follow the Cephes single precision approximations (as in sse_mathfun).
+// Every function uses the same sequence of IEEE operations for both widths
+// (no FMA contraction), so SSE and AVX2 produce bit-identical results.
+
+namespace voe
+{
+	namespace simd
+	{
+		enum class SimdLevel
+		{
+			Scalar = 0,
+			SSE = 1,
+			AVX2 = 2
+		};
+
+		// Highest instruction set supported by the CPU and the OS (cached after the first call).
+		VOE_API SimdLevel GetSimdLevel();
+
+		// ------------------------------------------------------------------
+		// 4 lanes (SSE2)
+		// ------------------------------------------------------------------
+		struct Int4 { __m128i v; };
+
+		struct Float4
+		{
+			using Int = Int4;
+			static constexpr uint32_t Width = 4;
+
+			__m128 v;
+
+			static Float4 Set1(float x) { return { _mm_set1_ps(x) }; }
+			static Float4 Load(const float* p) { return { _mm_loadu_ps(p) }; }
+			static Float4 Zero() { return { _mm_setzero_ps() }; }
+			void Store(float* p) const { _mm_storeu_ps(p, v); }
+		};
+
+		inline Float4 operator+(Float4 a, Float4 b) { return { _mm_add_ps(a.v, b.v) }; }
+		inline Float4 operator-(Float4 a, Float4 b) { return { _mm_sub_ps(a.v, b.v) }; }
+		inline Float4 operator*(Float4 a, Float4 b) { return { _mm_mul_ps(a.v, b.v) }; }
+		inline Float4 operator/(Float4 a, Float4 b) { return { _mm_div_ps(a.v, b.v) }; }
+		inline Float4 operator&(Float4 a, Float4 b) { return { _mm_and_ps(a.v, b.v) }; }
+		inline Float4 operator|(Float4 a, Float4 b) { return { _mm_or_ps(a.v, b.v) }; }
+		inline Float4 operator^(Float4 a, Float4 b) { return { _mm_xor_ps(a.v, b.v) }; }
+		inline Float4 AndNot(Float4 mask, Float4 a) { return { _mm_andnot_ps(mask.v, a.v) }; }
+		inline Float4 Min(Float4 a, Float4 b) { return { _mm_min_ps(a.v, b.v) }; }
+		inline Float4 Max(Float4 a, Float4 b) { return { _mm_max_ps(a.v, b.v) }; }
+		inline Float4 Sqrt(Float4 a) { return { _mm_sqrt_ps(a.v) }; }
+		inline Float4 CmpLt(Float4 a, Float4 b) { return { _mm_cmplt_ps(a.v, b.v) }; }
+		inline Float4 CmpGt(Float4 a, Float4 b) { return { _mm_cmpgt_ps(a.v, b.v) }; }
+		inline Float4 CmpEq(Float4 a, Float4 b) { return { _mm_cmpeq_ps(a.v, b.v) }; }
+		inline Float4 Select(Float4 mask, Float4 a, Float4 b) { return { _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)) }; }
+
+		inline Int4 operator+(Int4 a, Int4 b) { return { _mm_add_epi32(a.v, b.v) }; }
+		inline Int4 operator-(Int4 a, Int4 b) { return { _mm_sub_epi32(a.v, b.v) }; }
+		inline Int4 operator&(Int4 a, Int4 b) { return { _mm_and_si128(a.v, b.v) }; }
+		inline Int4 AndNot(Int4 mask, Int4 a) { return { _mm_andnot_si128(mask.v, a.v) }; }
+		inline Int4 CmpEq(Int4 a, Int4 b) { return { _mm_cmpeq_epi32(a.v, b.v) }; }
+		template<int N> inline Int4 ShiftLeft(Int4 a) { return { _mm_slli_epi32(a.v, N) }; }
+		template<int N> inline Int4 ShiftRight(Int4 a) { return { _mm_srli_epi32(a.v, N) }; }
+		inline Int4 ShiftLeft(Int4 a, int32_t n) { return { _mm_sll_epi32(a.v, _mm_cvtsi32_si128(n)) }; }
+		inline Int4 Set1(Int4, int32_t x) { return { _mm_set1_epi32(x) }; }
+		inline Int4 TruncateToInt(Float4 a) { return { _mm_cvttps_epi32(a.v) }; }
+		inline Float4 ToFloat(Int4 a) { return { _mm_cvtepi32_ps(a.v) }; }
+		inline Float4 AsFloat(Int4 a) { return { _mm_castsi128_ps(a.v) }; }
+		inline Int4 AsInt(Float4 a) { return { _mm_castps_si128(a.v) }; }
+
+		// Stores (re[i], im[i]) pairs to dst, i.e. 2 * Width floats.
+		inline void StoreInterleaved(float* dst, Float4 re, Float4 im)
+		{
+			_mm_storeu_ps(dst, _mm_unpacklo_ps(re.v, im.v));
+			_mm_storeu_ps(dst + 4, _mm_unpackhi_ps(re.v, im.v));
+		}
+
+		// Loads 2 * Width floats and splits the (a[i], b[i]) pairs, the inverse of StoreInterleaved.
+		inline void LoadDeinterleaved(const float* src, Float4& a, Float4& b)
+		{
+			__m128 lo = _mm_loadu_ps(src);
+			__m128 hi = _mm_loadu_ps(src + 4);
+			a.v = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+			b.v = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+		}
+
+		// base[index[i]] per lane. SSE2 has no gather, so the lanes are loaded one by one.
+		inline Float4 Gather(const float* base, Int4 index)
+		{
+			alignas(16) int32_t i[4];
+			_mm_store_si128(reinterpret_cast<__m128i*>(i), index.v);
+			return { _mm_setr_ps(base[i[0]], base[i[1]], base[i[2]], base[i[3]]) };
+		}
+
+		// ------------------------------------------------------------------
+		// 8 lanes (AVX2). Only call these after GetSimdLevel() reported AVX2.
+		// ------------------------------------------------------------------
+		struct Int8 { __m256i v; };
+
+		struct Float8
+		{
+			using Int = Int8;
+			static constexpr uint32_t Width = 8;
+
+			__m256 v;
+
+			static Float8 Set1(float x) { return { _mm256_set1_ps(x) }; }
+			static Float8 Load(const float* p) { return { _mm256_loadu_ps(p) }; }
+			static Float8 Zero() { return { _mm256_setzero_ps() }; }
+			void Store(float* p) const { _mm256_storeu_ps(p, v); }
+		};
+
+		inline Float8 operator+(Float8 a, Float8 b) { return { _mm256_add_ps(a.v, b.v) }; }
+		inline Float8 operator-(Float8 a, Float8 b) { return { _mm256_sub_ps(a.v, b.v) }; }
+		inline Float8 operator*(Float8 a, Float8 b) { return { _mm256_mul_ps(a.v, b.v) }; }
+		inline Float8 operator/(Float8 a, Float8 b) { return { _mm256_div_ps(a.v, b.v) }; }
+		inline Float8 operator&(Float8 a, Float8 b) { return { _mm256_and_ps(a.v, b.v) }; }
+		inline Float8 operator|(Float8 a, Float8 b) { return { _mm256_or_ps(a.v, b.v) }; }
+		inline Float8 operator^(Float8 a, Float8 b) { return { _mm256_xor_ps(a.v, b.v) }; }
+		inline Float8 AndNot(Float8 mask, Float8 a) { return { _mm256_andnot_ps(mask.v, a.v) }; }
+		inline Float8 Min(Float8 a, Float8 b) { return { _mm256_min_ps(a.v, b.v) }; }
+		inline Float8 Max(Float8 a, Float8 b) { return { _mm256_max_ps(a.v, b.v) }; }
+		inline Float8 Sqrt(Float8 a) { return { _mm256_sqrt_ps(a.v) }; }
+		inline Float8 CmpLt(Float8 a, Float8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ) }; }
+		inline Float8 CmpGt(Float8 a, Float8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ) }; }
+		inline Float8 CmpEq(Float8 a, Float8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ) }; }
+		inline Float8 Select(Float8 mask, Float8 a, Float8 b) { return { _mm256_blendv_ps(b.v, a.v, mask.v) }; }
+
+		inline Int8 operator+(Int8 a, Int8 b) { return { _mm256_add_epi32(a.v, b.v) }; }
+		inline Int8 operator-(Int8 a, Int8 b) { return { _mm256_sub_epi32(a.v, b.v) }; }
+		inline Int8 operator&(Int8 a, Int8 b) { return { _mm256_and_si256(a.v, b.v) }; }
+		inline Int8 AndNot(Int8 mask, Int8 a) { return { _mm256_andnot_si256(mask.v, a.v) }; }
+		inline Int8 CmpEq(Int8 a, Int8 b) { return { _mm256_cmpeq_epi32(a.v, b.v) }; }
+		template<int N> inline Int8 ShiftLeft(Int8 a) { return { _mm256_slli_epi32(a.v, N) }; }
+		template<int N> inline Int8 ShiftRight(Int8 a) { return { _mm256_srli_epi32(a.v, N) }; }
+		inline Int8 ShiftLeft(Int8 a, int32_t n) { return { _mm256_sll_epi32(a.v, _mm_cvtsi32_si128(n)) }; }
+		inline Int8 Set1(Int8, int32_t x) { return { _mm256_set1_epi32(x) }; }
+		inline Int8 TruncateToInt(Float8 a) { return { _mm256_cvttps_epi32(a.v) }; }
+		inline Float8 ToFloat(Int8 a) { return { _mm256_cvtepi32_ps(a.v) }; }
+		inline Float8 AsFloat(Int8 a) { return { _mm256_castsi256_ps(a.v) }; }
+		inline Int8 AsInt(Float8 a) { return { _mm256_castps_si256(a.v) }; }
+
+		inline void StoreInterleaved(float* dst, Float8 re, Float8 im)
+		{
+			__m256 lo = _mm256_unpacklo_ps(re.v, im.v);
+			__m256 hi = _mm256_unpackhi_ps(re.v, im.v);
+			_mm256_storeu_ps(dst, _mm256_permute2f128_ps(lo, hi, 0x20));
+			_mm256_storeu_ps(dst + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+		}
+
+		inline void LoadDeinterleaved(const float* src, Float8& a, Float8& b)
+		{
+			__m256 lo = _mm256_loadu_ps(src);
+			__m256 hi = _mm256_loadu_ps(src + 8);
+			// the shuffles work per 128 bit lane: (0, 1, 4, 5 | 2, 3, 6, 7), the permute puts them in order
+			__m256 even = _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+			__m256 odd = _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+			a.v = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(even), _MM_SHUFFLE(3, 1, 2, 0)));
+			b.v = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(odd), _MM_SHUFFLE(3, 1, 2, 0)));
+		}
+
+		inline Float8 Gather(const float* base, Int8 index) { return { _mm256_i32gather_ps(base, index.v, 4) }; }
+
+		// ------------------------------------------------------------------
+		// Width independent math
+		// ------------------------------------------------------------------
+		template<typename F>
+		inline typename F::Int SetInt(int32_t x)
+		{
+			return Set1(typename F::Int{}, x);
+		}
+
+		template<typename F>
+		inline F Abs(F x)
+		{
+			return AndNot(AsFloat(SetInt<F>(0x80000000)), x);
+		}
+
+		// Round toward negative infinity (valid for |x| < 2^31).
+		template<typename F>
+		inline F Floor(F x)
+		{
+			F t = ToFloat(TruncateToInt(x));
+			return t - (CmpGt(t, x) & F::Set1(1.0f));
+		}
+
+		// e^x, relative error ~1e-7 over [-88, 88]. Inputs are clamped to that range.
+		template<typename F>
+		inline F Exp(F x)
+		{
+			x = Min(x, F::Set1(88.3762626647949f));
+			x = Max(x, F::Set1(-88.3762626647949f));
+
+			// express e^x = 2^n * e^g, |g| <= ln2 / 2
+			F fx = Floor(x * F::Set1(1.44269504088896341f) + F::Set1(0.5f));
+			x = x - fx * F::Set1(0.693359375f);
+			x = x - fx * F::Set1(-2.12194440e-4f);
+
+			F z = x * x;
+			F y = F::Set1(1.9875691500e-4f);
+			y = y * x + F::Set1(1.3981999507e-3f);
+			y = y * x + F::Set1(8.3334519073e-3f);
+			y = y * x + F::Set1(4.1665795894e-2f);
+			y = y * x + F::Set1(1.6666665459e-1f);
+			y = y * x + F::Set1(5.0000001201e-1f);
+			y = y * z + x + F::Set1(1.0f);
+
+			// build 2^n
+			auto n = TruncateToInt(fx) + SetInt<F>(0x7f);
+			return y * AsFloat(ShiftLeft<23>(n));
+		}
+
+		// Natural logarithm for x > 0.
+		template<typename F>
+		inline F Log(F x)
+		{
+			auto bits = AsInt(x);
+			auto exponent = ShiftRight<23>(bits) - SetInt<F>(0x7f);
+
+			// keep the mantissa in [0.5, 1)
+			x = AsFloat(AndNot(SetInt<F>(0x7f800000), bits));
+			x = x | F::Set1(0.5f);
+
+			F e = ToFloat(exponent) + F::Set1(1.0f);
+
+			F mask = CmpLt(x, F::Set1(0.707106781186547524f));
+			F tmp = x & mask;
+			x = x - F::Set1(1.0f);
+			e = e - (F::Set1(1.0f) & mask);
+			x = x + tmp;
+
+			F z = x * x;
+			F y = F::Set1(7.0376836292e-2f);
+			y = y * x + F::Set1(-1.1514610310e-1f);
+			y = y * x + F::Set1(1.1676998740e-1f);
+			y = y * x + F::Set1(-1.2420140846e-1f);
+			y = y * x + F::Set1(1.4249322787e-1f);
+			y = y * x + F::Set1(-1.6668057665e-1f);
+			y = y * x + F::Set1(2.0000714765e-1f);
+			y = y * x + F::Set1(-2.4999993993e-1f);
+			y = y * x + F::Set1(3.3333331174e-1f);
+			y = y * x * z;
+
+			y = y + e * F::Set1(-2.12194440e-4f);
+			y = y - z * F::Set1(0.5f);
+			x = x + y;
+			return x + e * F::Set1(0.693359375f);
+		}
+
+		// Computes sin(x) and cos(x) together, accurate to ~1e-7 for |x| < 8192.
+		template<typename F>
+		inline void SinCos(F x, F& outSin, F& outCos)
+		{
+			F signBitSin = x & AsFloat(SetInt<F>(0x80000000));
+			x = Abs(x);
+
+			// octant of the argument
+			auto j = TruncateToInt(x * F::Set1(1.27323954473516f));
+			j = (j + SetInt<F>(1)) & SetInt<F>(~1);
+			F y = ToFloat(j);
+
+			F swapSignBitSin = AsFloat(ShiftLeft<29>(j & SetInt<F>(4)));
+			F polyMask = AsFloat(CmpEq(j & SetInt<F>(2), SetInt<F>(0)));
+			F signBitCos = AsFloat(ShiftLeft<29>(AndNot(j - SetInt<F>(2), SetInt<F>(4))));
+
+			// extended precision modular arithmetic: x = ((x - y * DP1) - y * DP2) - y * DP3
+			x = x + y * F::Set1(-0.78515625f);
+			x = x + y * F::Set1(-2.4187564849853515625e-4f);
+			x = x + y * F::Set1(-3.77489497744594108e-8f);
+
+			signBitSin = signBitSin ^ swapSignBitSin;
+
+			F z = x * x;
+
+			// cosine polynomial, valid on [-pi/4, pi/4]
+			F yc = F::Set1(2.443315711809948e-5f);
+			yc = yc * z + F::Set1(-1.388731625493765e-3f);
+			yc = yc * z + F::Set1(4.166664568298827e-2f);
+			yc = yc * z * z;
+			yc = yc - z * F::Set1(0.5f);
+			yc = yc + F::Set1(1.0f);
+
+			// sine polynomial, valid on [-pi/4, pi/4]
+			F ys = F::Set1(-1.9515295891e-4f);
+			ys = ys * z + F::Set1(8.3321608736e-3f);
+			ys = ys * z + F::Set1(-1.6666654611e-1f);
+			ys = ys * z * x;
+			ys = ys + x;
+
+			F sinValue = Select(polyMask, ys, yc);
+			F cosValue = Select(polyMask, yc, ys);
+
+			outSin = sinValue ^ signBitSin;
+			outCos = cosValue ^ signBitCos;
+		}
+	}
+}
@@ -0,0 +1,227 @@
+#include "PreCompileHeader.h"
+#include "ThreadPool.h"
+
+#ifndef VOE_PLATFORM_WINDOWS
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+namespace voe
+{
+	namespace
+	{
+		uint64_t PackRange(uint32_t begin, uint32_t end)
+		{
+			return static_cast<uint64_t>(begin) | (static_cast<uint64_t>(end) << 32);
+		}
+
+		void PinThread(std::thread& thread, uint32_t processor)
+		{
+#ifdef VOE_PLATFORM_WINDOWS
+			DWORD_PTR mask = static_cast<DWORD_PTR>(1) << (processor % (sizeof(DWORD_PTR) * 8));
+			if (SetThreadAffinityMask(thread.native_handle(), mask) == 0)
+			{
+				VOE_CORE_WARN("ThreadPool: failed to pin a worker to processor {0}", processor);
+			}
+#else
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			CPU_SET(processor % CPU_SETSIZE, &set);
+			if (pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) != 0)
+			{
+				VOE_CORE_WARN("ThreadPool: failed to pin a worker to processor {0}", processor);
+			}
+#endif
+		}
+	}
+
+	ThreadPool::ThreadPool(uint32_t threadCount, bool pinThreads)
+	{
+		if (threadCount == 0)
+		{
+			threadCount = std::max(1u, std::thread::hardware_concurrency());
+		}
+
+		m_Ranges = std::make_unique<ChunkRange[]>(threadCount);
+
+		m_Workers.reserve(threadCount - 1);
+		for (uint32_t i = 1; i < threadCount; i++)
+		{
+			m_Workers.emplace_back([this, i]() { WorkerLoop(i); });
+
+			if (pinThreads)
+			{
+				PinThread(m_Workers.back(), i);
+			}
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Stop = true;
+		}
+		m_WakeCondition.notify_all();
+
+		for (auto& worker : m_Workers)
+		{
+			worker.join();
+		}
+	}
+
+	void ThreadPool::Dispatch(const Job& job)
+	{
+		if (m_Workers.empty() || job.Count <= job.Grain)
+		{
+			job.Invoke(job.Context, 0, job.Count, 0);
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Job = job;
+
+			// an even share of the chunks for every thread, published by the mutex
+			uint32_t threadCount = GetThreadCount();
+			uint32_t chunkCount = (job.Count + job.Grain - 1) / job.Grain;
+			for (uint32_t i = 0; i < threadCount; i++)
+			{
+				uint32_t begin = static_cast<uint32_t>(static_cast<uint64_t>(chunkCount) * i / threadCount);
+				uint32_t end = static_cast<uint32_t>(static_cast<uint64_t>(chunkCount) * (i + 1) / threadCount);
+				m_Ranges[i].Bounds.store(PackRange(begin, end), std::memory_order_relaxed);
+			}
+			m_BusyWorkers = static_cast<uint32_t>(m_Workers.size());
+			m_Generation++;
+		}
+		m_WakeCondition.notify_all();
+
+		RunChunks(job, 0);
+
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_DoneCondition.wait(lock, [this]() { return m_BusyWorkers == 0; });
+	}
+
+	void ThreadPool::RunChunks(const Job& job, uint32_t threadIndex)
+	{
+		uint32_t chunk;
+		while (PopChunk(threadIndex, chunk) || StealChunk(threadIndex, chunk))
+		{
+			uint32_t begin = chunk * job.Grain;
+			uint32_t end = std::min(begin + job.Grain, job.Count);
+			job.Invoke(job.Context, begin, end, threadIndex);
+		}
+	}
+
+	bool ThreadPool::PopChunk(uint32_t threadIndex, uint32_t& chunk)
+	{
+		auto& bounds = m_Ranges[threadIndex].Bounds;
+		uint64_t range = bounds.load(std::memory_order_acquire);
+
+		for (;;)
+		{
+			uint32_t begin = static_cast<uint32_t>(range);
+			uint32_t end = static_cast<uint32_t>(range >> 32);
+			if (begin >= end)
+			{
+				return false;
+			}
+
+			if (bounds.compare_exchange_weak(range, PackRange(begin + 1, end), std::memory_order_acq_rel))
+			{
+				chunk = begin;
+				return true;
+			}
+		}
+	}
+
+	bool ThreadPool::StealChunk(uint32_t threadIndex, uint32_t& chunk)
+	{
+		const uint32_t threadCount = GetThreadCount();
+
+		for (uint32_t i = 1; i < threadCount; i++)
+		{
+			auto& bounds = m_Ranges[(threadIndex + i) % threadCount].Bounds;
+			uint64_t range = bounds.load(std::memory_order_acquire);
+
+			for (;;)
+			{
+				uint32_t begin = static_cast<uint32_t>(range);
+				uint32_t end = static_cast<uint32_t>(range >> 32);
+				if (begin >= end)
+				{
+					break;
+				}
+
+				// take the back half, run its first chunk now and keep the rest as the own range
+				uint32_t split = end - (end - begin + 1) / 2;
+				if (bounds.compare_exchange_weak(range, PackRange(begin, split), std::memory_order_acq_rel))
+				{
+					chunk = split;
+					m_Ranges[threadIndex].Bounds.store(PackRange(split + 1, end), std::memory_order_release);
+					return true;
+				}
+			}
+		}
+
+		return false;
+	}
+
+	void ThreadPool::WorkerLoop(uint32_t threadIndex)
+	{
+		uint64_t generation = 0;
+
+		for (;;)
+		{
+			Job job;
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_WakeCondition.wait(lock, [this, generation]() { return m_Stop || m_Generation != generation; });
+
+				if (m_Stop)
+				{
+					return;
+				}
+
+				generation = m_Generation;
+				job = m_Job;
+			}
+
+			RunChunks(job, threadIndex);
+
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_BusyWorkers--;
+			}
+			m_DoneCondition.notify_one();
+		}
+	}
+
+	uint32_t ThreadPool::GetL2CacheSize()
+	{
+		const uint32_t defaultSize = 256 * 1024;
+
+#ifdef VOE_PLATFORM_WINDOWS
+		DWORD length = 0;
+		GetLogicalProcessorInformation(nullptr, &length);
+
+		std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> infos(length / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+		if (infos.empty() || !GetLogicalProcessorInformation(infos.data(), &length))
+		{
+			return defaultSize;
+		}
+
+		for (const auto& info : infos)
+		{
+			if (info.Relationship == RelationCache && info.Cache.Level == 2 && info.Cache.Size > 0)
+			{
+				return static_cast<uint32_t>(info.Cache.Size);
+			}
+		}
+		return defaultSize;
+#else
+		long size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+		return size > 0 ? static_cast<uint32_t>(size) : defaultSize;
+#endif
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace voe
+{
+	// Persistent worker threads for data parallel loops.
+	// The calling thread takes part in every loop, so a pool of N threads spawns N - 1 workers.
+	// Every loop is split into one contiguous range of chunks per thread. A thread works through
+	// its own range front to back and, once it is empty, steals the back half of another one,
+	// so neighbouring chunks mostly stay on the same core and uneven chunks still balance out.
+	// Dispatching a loop doesn't allocate, which keeps per-frame simulation steps allocation free.
+	class VOE_API ThreadPool
+	{
+	public:
+		// threadCount = 0 uses every hardware thread.
+		// pinThreads binds worker i to logical processor i (the calling thread is left alone).
+		explicit ThreadPool(uint32_t threadCount = 0, bool pinThreads = false);
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		uint32_t GetThreadCount() const { return static_cast<uint32_t>(m_Workers.size()) + 1; }
+
+		// Size of the L2 cache of one core in bytes, used to size chunks. 256 KiB if unknown.
+		static uint32_t GetL2CacheSize();
+
+		// Calls func(begin, end, threadIndex) for chunks of at most grain items covering [0, count).
+		// threadIndex is in [0, GetThreadCount()) and can be used to pick per-thread scratch memory.
+		// Returns after every chunk has finished.
+		template<typename Func>
+		void ParallelFor(uint32_t count, uint32_t grain, Func&& func)
+		{
+			using FuncType = std::remove_reference_t<Func>;
+
+			auto invoke = [](void* context, uint32_t begin, uint32_t end, uint32_t threadIndex)
+			{
+				(*static_cast<FuncType*>(context))(begin, end, threadIndex);
+			};
+
+			Dispatch({ invoke, const_cast<void*>(static_cast<const void*>(&func)), count, grain > 0 ? grain : 1 });
+		}
+
+	private:
+		struct Job
+		{
+			void (*Invoke)(void*, uint32_t, uint32_t, uint32_t);
+			void* Context;
+			uint32_t Count;
+			uint32_t Grain;
+		};
+
+		// Chunks [begin, end) still owned by one thread, packed as begin | end << 32 so that
+		// the owner and thieves can update both ends with a single compare exchange.
+		struct alignas(64) ChunkRange
+		{
+			std::atomic<uint64_t> Bounds = 0;
+		};
+
+		void Dispatch(const Job& job);
+		void RunChunks(const Job& job, uint32_t threadIndex);
+		bool PopChunk(uint32_t threadIndex, uint32_t& chunk);
+		bool StealChunk(uint32_t threadIndex, uint32_t& chunk);
+		void WorkerLoop(uint32_t threadIndex);
+
+		std::vector<std::thread> m_Workers;
+		std::unique_ptr<ChunkRange[]> m_Ranges;
+
+		std::mutex m_Mutex;
+		std::condition_variable m_WakeCondition;
+		std::condition_variable m_DoneCondition;
+
+		Job m_Job = {};
+		uint64_t m_Generation = 0;
+		uint32_t m_BusyWorkers = 0;
+		bool m_Stop = false;
+	};
+}
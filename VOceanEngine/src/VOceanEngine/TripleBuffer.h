@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace voe
+{
+	// Lock-free handoff of the latest value from one writer thread to one reader thread.
+	// The writer fills its own buffer and publishes it by swapping it with the middle one,
+	// the reader swaps the middle one with its own buffer when something new was published.
+	// Neither side ever waits for the other: the writer can publish faster than the reader
+	// picks up (older values are overwritten) and the reader keeps its buffer as long as it likes.
+	template<typename T>
+	class TripleBuffer
+	{
+	public:
+		TripleBuffer() = default;
+
+		TripleBuffer(const TripleBuffer&) = delete;
+		TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+		// Calls func(T&) for every buffer, e.g. to allocate them up front.
+		// Only before the writer and reader threads are running.
+		template<typename Func>
+		void ForEach(Func&& func)
+		{
+			for (T& buffer : m_Buffers)
+				func(buffer);
+		}
+
+		// writer thread
+		T& GetWriteBuffer() { return m_Buffers[m_WriteIndex]; }
+
+		void Publish()
+		{
+			uint32_t previous = m_Middle.exchange(m_WriteIndex | DirtyBit, std::memory_order_acq_rel);
+			m_WriteIndex = previous & IndexMask;
+		}
+
+		// reader thread
+		// Takes the latest published buffer, returns false if nothing was published since the last call.
+		bool Update()
+		{
+			if ((m_Middle.load(std::memory_order_relaxed) & DirtyBit) == 0)
+				return false;
+
+			uint32_t previous = m_Middle.exchange(m_ReadIndex, std::memory_order_acq_rel);
+			m_ReadIndex = previous & IndexMask;
+			return true;
+		}
+
+		const T& GetReadBuffer() const { return m_Buffers[m_ReadIndex]; }
+
+	private:
+		static constexpr uint32_t IndexMask = 3;
+		// set while the middle buffer holds a value the reader hasn't taken yet
+		static constexpr uint32_t DirtyBit = 4;
+
+		std::array<T, 3> m_Buffers;
+
+		// the index of the middle buffer and DirtyBit, the only state shared by both threads
+		alignas(64) std::atomic<uint32_t> m_Middle = 1;
+		// each owned by one thread, kept on their own cache lines
+		alignas(64) uint32_t m_WriteIndex = 0;
+		alignas(64) uint32_t m_ReadIndex = 2;
+	};
+}
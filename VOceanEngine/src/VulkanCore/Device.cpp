@@ -102,7 +102,7 @@ namespace voe {
         vkDestroyDevice(m_Device, nullptr);
 	}
 
-    void Device::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory)
+    void Device::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory, VkSharingMode sharingMode)
     {
         VkBufferCreateInfo bufferInfo = {};
         bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -110,6 +110,15 @@ namespace voe {
         bufferInfo.usage = usage;
         bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
+        // concurrent between the graphics and compute queues, only needed if they are different families
+        uint32_t queueFamilies[] = { m_Indices.graphicsFamily, m_Indices.computeFamily };
+        if (sharingMode == VK_SHARING_MODE_CONCURRENT && queueFamilies[0] != queueFamilies[1])
+        {
+            bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+            bufferInfo.queueFamilyIndexCount = 2;
+            bufferInfo.pQueueFamilyIndices = queueFamilies;
+        }
+
         VOE_CHECK_RESULT(vkCreateBuffer(m_Device, &bufferInfo, nullptr, &buffer));
 
         VkMemoryRequirements memRequirements;
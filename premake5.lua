@@ -134,6 +134,13 @@ project "Sandbox"
 		"VOceanEngine"
 	}
 
+	-- FFT.spv, FFTStockham.spv, oceanNormal.spv and testVert.spv are not committed, they are
+	-- built from Assets/Shaders and validated before every build
+	prebuildcommands
+	{
+		"cd Assets/Shaders && call compile.bat nopause"
+	}
+
 	filter "system:windows"
 		cppdialect "C++17"
 		staticruntime "On"